@@ -0,0 +1,60 @@
+#!/usr/bin/env bash
+# Code size and compile time of OBF / OBF_W against the xorstr-style and skCrypter-style
+# references in bench/ref, then the runtime comparison from bench/compare.cpp.
+# Each implementation gets one TU with COUNT (default 500) distinct 40-character
+# literals, one function per literal; sizes are the sections of that object file.
+# Usage: bench/compare.sh [COUNT]   (CXX / CXXFLAGS are honoured)
+set -euo pipefail
+
+CXX=${CXX:-g++}
+CXXFLAGS=${CXXFLAGS:--std=c++17 -O2 -march=native}
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+COUNT=${1:-500}
+
+impls=(plain obf xorstr skcrypter plain_w obf_w xorstr_w skcrypter_w)
+declare -A use=(
+    [plain]='(%s)'                     [plain_w]='(L%s)'
+    [obf]='OBF(%s)'                    [obf_w]='OBF_W(L%s)'
+    [xorstr]='XORSTR_STYLE(%s)'        [xorstr_w]='XORSTR_STYLE(L%s)'
+    [skcrypter]='SKCRYPTER_STYLE(%s).decrypt()' [skcrypter_w]='SKCRYPTER_STYLE(L%s).decrypt()'
+)
+
+section_bytes() {
+    size -A "$1" | awk -v re="$2" '$1 ~ re { n += $2 } END { print n + 0 }'
+}
+
+# The same includes with no literals; its sections are subtracted from every row.
+emit_tu() {
+    printf '#include "%s/obfuscator.h"\n#include "%s/bench/ref/xorstr_style.h"\n' "$ROOT" "$ROOT"
+    printf '#include "%s/bench/ref/skcrypter_style.h"\n' "$ROOT"
+    printf 'template<typename C> void sink(const C* p) { __asm__ __volatile__("" : : "r"(p) : "memory"); }\n'
+    for ((i = 0; i < $2; ++i)); do
+        literal=$(printf '"config.section.%06d.key=value/xyz"' "$i")
+        # shellcheck disable=SC2059
+        printf "void f$i() { sink($(printf "$1" "$literal")); }\n"
+    done
+}
+emit_tu '' 0 > "$WORK/empty.cpp"
+$CXX $CXXFLAGS -c "$WORK/empty.cpp" -o "$WORK/empty.o"
+base_text=$(section_bytes "$WORK/empty.o" '^\\.text')
+base_rodata=$(section_bytes "$WORK/empty.o" '^\\.rodata')
+base_data=$(section_bytes "$WORK/empty.o" '^\\.(data|bss)')
+
+printf '%-12s %-12s %-10s %-10s %-10s %-12s\n' "impl" "compile (s)" ".text" ".rodata" ".data" "bytes/string"
+for impl in "${impls[@]}"; do
+    emit_tu "${use[$impl]}" "$COUNT" > "$WORK/$impl.cpp"
+    start=$(date +%s.%N)
+    $CXX $CXXFLAGS -c "$WORK/$impl.cpp" -o "$WORK/$impl.o"
+    end=$(date +%s.%N)
+    text=$(( $(section_bytes "$WORK/$impl.o" '^\\.text') - base_text ))
+    rodata=$(( $(section_bytes "$WORK/$impl.o" '^\\.rodata') - base_rodata ))
+    data=$(( $(section_bytes "$WORK/$impl.o" '^\\.(data|bss)') - base_data ))
+    awk -v i="$impl" -v s="$start" -v e="$end" -v t="$text" -v r="$rodata" -v d="$data" -v n="$COUNT" \
+        'BEGIN { printf "%-12s %-12.2f %-10d %-10d %-10d %-12.1f\n", i, e - s, t, r, d, (t + r + d) / n }'
+done
+
+echo
+$CXX $CXXFLAGS -pthread "$ROOT/bench/compare.cpp" -o "$WORK/compare_bench"
+"$WORK/compare_bench"
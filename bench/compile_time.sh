@@ -0,0 +1,28 @@
+#!/usr/bin/env bash
+# Compile-time benchmark for OBF_LARGE: one TU per payload size, timed end to end.
+# Usage: bench/compile_time.sh [sizes...]   (CXX / CXXFLAGS are honoured)
+set -euo pipefail
+
+CXX=${CXX:-g++}
+CXXFLAGS=${CXXFLAGS:--std=c++17 -O2}
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+sizes=("$@")
+[ ${#sizes[@]} -eq 0 ] && sizes=(65536 1048576 8388608)
+
+printf '%-10s %-12s %-10s\n' "bytes" "compile (s)" "MiB/s"
+for n in "${sizes[@]}"; do
+    tu="$WORK/large_$n.cpp"
+    {
+        printf '#include "%s/obfuscator.h"\n#define PAYLOAD "' "$ROOT"
+        head -c $(( n * 3 / 4 + 3 )) /dev/urandom | base64 -w0 | cut -c1-"$n" | tr -d "\n"
+        printf '"\nconst char* payload() { return OBF_LARGE(PAYLOAD); }\n'
+    } > "$tu"
+    start=$(date +%s.%N)
+    $CXX $CXXFLAGS -c "$tu" -o "$WORK/large_$n.o"
+    end=$(date +%s.%N)
+    awk -v n="$n" -v s="$start" -v e="$end" \
+        'BEGIN { t = e - s; printf "%-10d %-12.2f %-10.3f\n", n, t, n / 1048576 / t }'
+done
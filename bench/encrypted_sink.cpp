@@ -0,0 +1,66 @@
+// Throughput of obf::encrypted_sink against writing the same data in plaintext.
+//
+// Writes 1 GiB (or argv[2] MiB) to a file in the directory argv[1] (default .), once as
+// 128-byte log lines and once as 64 KiB records. The baseline is stdio with a 1 MiB
+// buffer; the sink is measured through the page cache and with O_DIRECT. Every run ends
+// with fsync so the numbers include the device, and the file is removed afterwards.
+//
+//   g++ -std=c++17 -O2 -march=native -pthread bench/encrypted_sink.cpp -o sink_bench && ./sink_bench /var/tmp
+#include "../obfuscator_io.h"
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+
+double seconds_since(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+double plain_mib_s(const std::string& path, std::size_t total, std::size_t record) {
+    std::vector<char> data(record, 'x');
+    std::vector<char> buffer(obf::encrypted_sink::default_buffer);
+    const auto t0 = std::chrono::steady_clock::now();
+    std::FILE* f = std::fopen(path.c_str(), "wb");
+    std::setvbuf(f, buffer.data(), _IOFBF, buffer.size());
+    for (std::size_t done = 0; done < total; done += record) {
+        std::fwrite(data.data(), 1, record, f);
+    }
+    std::fflush(f);
+    fsync(fileno(f));
+    std::fclose(f);
+    const double s = seconds_since(t0);
+    std::remove(path.c_str());
+    return static_cast<double>(total) / s / (1 << 20);
+}
+
+double sink_mib_s(const std::string& path, std::size_t total, std::size_t record, bool direct) {
+    std::vector<char> data(record, 'x');
+    const auto t0 = std::chrono::steady_clock::now();
+    auto sink = obf::encrypted_sink::open(path.c_str(), 0x5eed, obf::encrypted_sink::default_buffer, direct);
+    for (std::size_t done = 0; done < total; done += record) {
+        sink.write(data.data(), record);
+    }
+    sink.close();
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    fsync(fd);
+    ::close(fd);
+    const double s = seconds_since(t0);
+    std::remove(path.c_str());
+    return static_cast<double>(total) / s / (1 << 20);
+}
+
+}
+
+int main(int argc, char** argv) {
+    const std::string path = std::string(argc > 1 ? argv[1] : ".") + "/obf_sink_bench.bin";
+    const std::size_t total = (argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1024) << 20;
+    std::printf("%-8s %12s %12s %12s %8s\n", "record", "plain MiB/s", "obf MiB/s", "direct MiB/s", "ratio");
+    for (std::size_t record : { std::size_t{128}, std::size_t{65536} }) {
+        const double p = plain_mib_s(path, total, record);
+        const double o = sink_mib_s(path, total, record, false);
+        const double d = sink_mib_s(path, total, record, true);
+        std::printf("%-8zu %12.0f %12.0f %12.0f %8.2f\n", record, p, o, d, std::max(o, d) / p);
+    }
+}
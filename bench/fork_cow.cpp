@@ -0,0 +1,117 @@
+// Cost of fork() children for each obf::fork_policy, in a parent holding 512 decrypted
+// strings of ~1 KiB (about 128 pages of plaintext). For every policy the parent forks
+// kChildren children one after another and reports, per child:
+//   startup us - fork() in the parent until the child is running its own code (includes
+//                the atfork handler, so the up-front work of wipe shows here)
+//   total us   - fork() until the child has been reaped
+//   minflt     - minor page faults of the child (getrusage RUSAGE_CHILDREN), mostly
+//                copy-on-write of the pages it wrote
+// Two child workloads: "exit" returns through exit(), running the string destructors,
+// and "use" reads every string first. "floor" is a child that calls _exit() at once,
+// skipping the destructors.
+//
+//   g++ -std=c++17 -O2 bench/fork_cow.cpp -o fork_cow && ./fork_cow
+#include "../obfuscator_fork.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+namespace {
+
+constexpr int kChildren = 200;
+
+__attribute__((always_inline)) inline void sink(const char* p) noexcept {
+    __asm__ __volatile__("" : : "r"(p) : "memory");
+}
+
+using use_fn = void (*)();
+
+#define REP2(...) __VA_ARGS__, __VA_ARGS__
+#define REP8(...) REP2(REP2(REP2(__VA_ARGS__)))
+#define REP512(...) REP8(REP8(REP8(__VA_ARGS__)))
+
+#define STR_64 "0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef"
+#define STR_1K STR_64 STR_64 STR_64 STR_64 STR_64 STR_64 STR_64 STR_64 \
+    STR_64 STR_64 STR_64 STR_64 STR_64 STR_64 STR_64 "0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcde"
+
+constexpr use_fn sites[] = { REP512(+[] { sink(OBF(STR_1K)); }) };
+
+enum class workload { floor, exit, use };
+
+long minflt_children() {
+    rusage ru{};
+    getrusage(RUSAGE_CHILDREN, &ru);
+    return ru.ru_minflt;
+}
+
+double us(std::chrono::steady_clock::duration d) {
+    return std::chrono::duration<double, std::micro>(d).count();
+}
+
+void run(const char* label, obf::fork_policy policy, workload w) {
+    obf::set_fork_policy(policy);
+    int fds[2];
+    if (pipe(fds) != 0) {
+        std::perror("pipe");
+        std::exit(1);
+    }
+    std::fflush(stdout);  // or every child flushes the parent's buffered output again
+    const long flt0 = minflt_children();
+    double startup = 0;
+    double total = 0;
+    for (int c = 0; c < kChildren; ++c) {
+        const auto t0 = std::chrono::steady_clock::now();
+        const pid_t pid = fork();
+        if (pid == 0) {
+            const double v = us(std::chrono::steady_clock::now() - t0);
+            if (write(fds[1], &v, sizeof(v)) != sizeof(v) || w == workload::floor) {
+                _exit(0);
+            }
+            if (w == workload::use) {
+                for (use_fn use : sites) {
+                    use();
+                }
+            }
+            std::exit(0);
+        }
+        double v = 0;
+        if (read(fds[0], &v, sizeof(v)) != sizeof(v)) {
+            std::perror("read");
+            std::exit(1);
+        }
+        waitpid(pid, nullptr, 0);
+        total += us(std::chrono::steady_clock::now() - t0);
+        startup += v;
+    }
+    close(fds[0]);
+    close(fds[1]);
+    const char* child = w == workload::floor ? "_exit" : w == workload::exit ? "exit" : "use";
+    std::printf("%-8s %-6s %12.1f %10.1f %10.1f\n", label, child, startup / kChildren, total / kChildren,
+                static_cast<double>(minflt_children() - flt0) / kChildren);
+}
+
+}
+
+int main() {
+    for (use_fn use : sites) {
+        use();
+    }
+    std::printf("%zu strings decrypted in the parent\n\n", obf::resident_plaintext());
+    std::printf("%-8s %-6s %12s %10s %10s\n", "policy", "child", "startup us", "total us", "minflt");
+    run("floor", obf::fork_policy::inherit, workload::floor);
+    const struct {
+        const char* label;
+        obf::fork_policy policy;
+    } policies[] = {
+        { "inherit", obf::fork_policy::inherit },
+        { "share", obf::fork_policy::share },
+        { "wipe", obf::fork_policy::wipe },
+        { "rekey", obf::fork_policy::rekey },
+    };
+    for (const auto& p : policies) {
+        run(p.label, p.policy, workload::exit);
+        run(p.label, p.policy, workload::use);
+    }
+}
@@ -0,0 +1,47 @@
+// obf::getenv against libc getenv on a realistically sized environment.
+//
+// The environment is padded to 64 entries, several sharing a prefix with the variable
+// looked up, which sits last. Both lookups walk the same array; the obfuscated one
+// decrypts its name byte by byte in registers instead of reading a plaintext literal.
+//
+//   g++ -std=c++17 -O2 bench/getenv.cpp -o getenv_bench && ./getenv_bench
+#include "../obfuscator.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+namespace {
+
+constexpr int kLookups = 1 << 20;
+
+template<typename F>
+double ns_per_lookup(F&& lookup) {
+    std::size_t sink = 0;
+    const auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < kLookups; ++i) {
+        const char* v = lookup();
+        sink += v != nullptr ? static_cast<unsigned char>(v[0]) : 0;
+    }
+    const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+    if (sink == 1) {
+        std::puts("");
+    }
+    return ns / kLookups;
+}
+
+}
+
+int main() {
+    for (int i = 0; i < 64; ++i) {
+        const std::string name = (i % 4 == 0 ? "SERVICE_API_" : "PADDING_VAR_") + std::to_string(i);
+        setenv(name.c_str(), "x", 0);
+    }
+    setenv("SERVICE_API_TOKEN", "t0ken", 1);
+
+    auto& name = OBF_REF("SERVICE_API_TOKEN");
+    const double libc = ns_per_lookup([] { return std::getenv("SERVICE_API_TOKEN"); });
+    const double obf = ns_per_lookup([&] { return obf::getenv(name); });
+    std::printf("%-16s %8.1f ns/lookup\n", "libc getenv", libc);
+    std::printf("%-16s %8.1f ns/lookup\n", "obf::getenv", obf);
+}
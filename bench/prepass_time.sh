@@ -0,0 +1,35 @@
+#!/usr/bin/env bash
+# Compile time of a TU with many OBF literals, header-only vs. run through
+# tools/obf_encrypt first. Usage: bench/prepass_time.sh [literals]   (CXX / CXXFLAGS are honoured)
+set -euo pipefail
+
+CXX=${CXX:-g++}
+CXXFLAGS=${CXXFLAGS:--std=c++17 -O0}
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+count=${1:-5000}
+
+$CXX -std=c++17 -O2 "$ROOT/tools/obf_encrypt.cpp" -o "$WORK/obf_encrypt"
+{
+    printf '#include "%s/obfuscator.h"\n#include <cstring>\nstd::size_t f() {\n    std::size_t n = 0;\n' "$ROOT"
+    for ((i = 0; i < count; ++i)); do
+        printf '    n += std::strlen(OBF("literal-%d-%s"));\n' "$i" "$(head -c 18 /dev/urandom | base64 -w0)"
+    done
+    printf '    return n;\n}\n'
+} > "$WORK/lits.cpp"
+
+time_compile() {
+    local start end
+    start=$(date +%s.%N)
+    $CXX $CXXFLAGS -c "$1" -o "$WORK/out.o"
+    end=$(date +%s.%N)
+    awk -v s="$start" -v e="$end" 'BEGIN { printf "%.2f", e - s }'
+}
+
+start=$(date +%s.%N)
+"$WORK/obf_encrypt" "$WORK/lits.cpp" -o "$WORK/lits_gen.cpp" 2>/dev/null
+end=$(date +%s.%N)
+printf '%-22s %8s s\n' "header-only" "$(time_compile "$WORK/lits.cpp")"
+printf '%-22s %8s s\n' "obf_encrypt pass" "$(awk -v s="$start" -v e="$end" 'BEGIN { printf "%.2f", e - s }')"
+printf '%-22s %8s s\n' "pre-encrypted" "$(time_compile "$WORK/lits_gen.cpp")"
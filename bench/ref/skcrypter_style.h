@@ -0,0 +1,68 @@
+// Clean-room skCrypter-style obfuscator, used only as a reference point by
+// bench/compare.cpp. Written from the technique's public description, not from the
+// original source; MIT like the rest of this repository.
+//
+// The technique: a constexpr object holds the ciphertext, XORed per code unit with
+// k1 + i % (1 + k2) where both keys come from __TIME__. Each use copies the object to the
+// stack and decrypts the copy in place with a scalar loop; there is no cache, and
+// clear() / encrypt() are left to the caller.
+//
+//     std::puts(SKCRYPTER_STYLE("text").decrypt());
+#pragma once
+#include <cstddef>
+#include <type_traits>
+
+namespace skcrypter_style {
+
+template<typename CharT, std::size_t N, int K1, int K2>
+class crypter {
+public:
+    constexpr explicit crypter(const CharT (&str)[N]) noexcept : data_{} {
+        for (std::size_t i = 0; i < N; ++i) {
+            data_[i] = static_cast<CharT>(str[i] ^ key(i));
+        }
+    }
+
+    const CharT* decrypt() noexcept {
+        if (encrypted_) {
+            for (std::size_t i = 0; i < N; ++i) {
+                data_[i] = static_cast<CharT>(data_[i] ^ key(i));
+            }
+            encrypted_ = false;
+        }
+        return data_;
+    }
+
+    void encrypt() noexcept {
+        if (!encrypted_) {
+            for (std::size_t i = 0; i < N; ++i) {
+                data_[i] = static_cast<CharT>(data_[i] ^ key(i));
+            }
+            encrypted_ = true;
+        }
+    }
+
+    void clear() noexcept {
+        for (std::size_t i = 0; i < N; ++i) {
+            data_[i] = 0;
+        }
+    }
+
+private:
+    static constexpr CharT key(std::size_t i) noexcept {
+        return static_cast<CharT>(K1 + static_cast<int>(i % (1 + K2)));
+    }
+
+    CharT data_[N];
+    bool encrypted_ = true;
+};
+
+}
+
+#define SKCRYPTER_STYLE(str) \
+    []() { \
+        using char_t = std::remove_const_t<std::remove_reference_t<decltype((str)[0])>>; \
+        constexpr static ::skcrypter_style::crypter<char_t, sizeof(str) / sizeof((str)[0]), __TIME__[4], __TIME__[7]> \
+            crypted(str); \
+        return crypted; \
+    }()
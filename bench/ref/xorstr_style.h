@@ -0,0 +1,110 @@
+// Clean-room xorstr-style obfuscator, used only as a reference point by bench/compare.cpp.
+// Written from the technique's public description, not from the original source; MIT like
+// the rest of this repository.
+//
+// The technique: the ciphertext and the key are packed into 64-bit words that become
+// template arguments, so every use site materializes them as immediate moves into a stack
+// buffer and decrypts that with 256-bit XORs. Nothing is stored in .rodata and nothing is
+// cached, so every use pays the full decryption and the plaintext lives on the stack only
+// for the enclosing full-expression.
+//
+//     std::puts(XORSTR_STYLE("text"));
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#define XORSTR_STYLE_INLINE __attribute__((always_inline)) inline
+
+namespace xorstr_style {
+
+constexpr uint64_t key_word(uint64_t seed, std::size_t i) noexcept {
+    uint64_t z = seed + 0x9e3779b97f4a7c15ull * (i + 1);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+// Keeps V out of constant propagation, so it is emitted as an immediate load at the use.
+template<uint64_t V>
+XORSTR_STYLE_INLINE uint64_t immediate() noexcept {
+    uint64_t v = V;
+    __asm__("" : "+r"(v));
+    return v;
+}
+
+template<typename CharT, uint64_t Seed, uint64_t... Cipher>
+class xor_string {
+    static constexpr std::size_t Words = sizeof...(Cipher);
+    static_assert(Words % 4 == 0, "whole 32-byte lanes");
+
+public:
+    XORSTR_STYLE_INLINE xor_string() noexcept {
+        std::size_t i = 0;
+        ((buffer_[i++] = immediate<Cipher>()), ...);
+    }
+
+    XORSTR_STYLE_INLINE const CharT* get() noexcept {
+        decrypt(std::make_index_sequence<Words / 4>{});
+        return reinterpret_cast<const CharT*>(buffer_);
+    }
+
+private:
+    template<std::size_t... L>
+    XORSTR_STYLE_INLINE void decrypt(std::index_sequence<L...>) noexcept {
+        (decrypt_lane<L>(), ...);
+    }
+
+    template<std::size_t L>
+    XORSTR_STYLE_INLINE void decrypt_lane() noexcept {
+#if defined(__AVX2__)
+        const __m256i key = _mm256_set_epi64x(
+            static_cast<long long>(immediate<key_word(Seed, 4 * L + 3)>()),
+            static_cast<long long>(immediate<key_word(Seed, 4 * L + 2)>()),
+            static_cast<long long>(immediate<key_word(Seed, 4 * L + 1)>()),
+            static_cast<long long>(immediate<key_word(Seed, 4 * L)>()));
+        auto* p = reinterpret_cast<__m256i*>(buffer_ + 4 * L);
+        _mm256_store_si256(p, _mm256_xor_si256(_mm256_load_si256(p), key));
+#else
+        buffer_[4 * L] ^= immediate<key_word(Seed, 4 * L)>();
+        buffer_[4 * L + 1] ^= immediate<key_word(Seed, 4 * L + 1)>();
+        buffer_[4 * L + 2] ^= immediate<key_word(Seed, 4 * L + 2)>();
+        buffer_[4 * L + 3] ^= immediate<key_word(Seed, 4 * L + 3)>();
+#endif
+    }
+
+    alignas(32) uint64_t buffer_[Words];
+};
+
+// Little-endian code units packed into words, zero padded, XORed with the key.
+template<typename CharT, std::size_t N, uint64_t Seed, typename L>
+constexpr uint64_t cipher_word(L literal, std::size_t w) noexcept {
+    uint64_t word = 0;
+    for (std::size_t b = 0; b < 8; ++b) {
+        const std::size_t byte = 8 * w + b;
+        const std::size_t unit = byte / sizeof(CharT);
+        if (unit < N) {
+            const auto c = static_cast<uint64_t>(static_cast<std::make_unsigned_t<CharT>>(literal()[unit]));
+            word |= ((c >> (8 * (byte % sizeof(CharT)))) & 0xff) << (8 * b);
+        }
+    }
+    return word ^ key_word(Seed, w);
+}
+
+template<uint64_t Seed, typename L, std::size_t N, std::size_t... W>
+XORSTR_STYLE_INLINE auto make(L literal, std::integral_constant<std::size_t, N>, std::index_sequence<W...>) noexcept {
+    using CharT = std::remove_const_t<std::remove_pointer_t<decltype(literal())>>;
+    return xor_string<CharT, Seed, cipher_word<CharT, N, Seed>(literal, W)...>();
+}
+
+}
+
+#define XORSTR_STYLE(str) \
+    ::xorstr_style::make<::xorstr_style::key_word(__COUNTER__, __LINE__)>( \
+        []() { return str; }, \
+        std::integral_constant<std::size_t, sizeof(str) / sizeof(*(str))>{}, \
+        std::make_index_sequence<(sizeof(str) + 31) / 32 * 4>{}).get()
@@ -0,0 +1,370 @@
+// libobf: the runtime kernels of obfuscator.h compiled once, behind the C ABI in obf.h.
+//
+// Each kernel exists per instruction set (AVX-512F, AVX2, SSE2 on x86-64; a portable
+// block loop elsewhere, left to the compiler's vectorizer). The set is chosen with
+// __builtin_cpu_supports on first use, so one binary runs the best variant everywhere
+// and picks up new ones when the library is rebuilt, without rebuilding its users.
+//
+//   build:   make -C libobf            (libobf.a and libobf.so, see libobf/Makefile)
+//   user:    g++ -std=c++17 -O2 -DOBF_USE_LIB app.cpp -Llibobf -lobf
+#undef OBF_USE_LIB
+#include "../obfuscator.h"
+#include "obf.h"
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define OBF_LIB_X86 1
+#endif
+
+namespace {
+
+// Code units XOR with zero-extended key bytes, so a 2- or 4-byte string is a byte string
+// whose key repeats every 64 or 128 bytes. Every kernel below works on such a pattern of
+// p = 32 * unit bytes, repeated to fill all 128 so a 64-byte load at any multiple of 32
+// below p stays inside it.
+struct pattern {
+    alignas(64) uint8_t bytes[128];
+    std::size_t size;
+
+    // unit must be 1, 2 or 4 (checked by the entry points): anything else would not tile
+    // the 128-byte buffer.
+    pattern(const uint8_t* key, std::size_t unit) noexcept : size(32 * unit) {
+        for (std::size_t i = 0; i < 32; ++i) {
+            if (unit == 1) {
+                bytes[i] = key[i];
+            } else if (unit == 2) {
+                const uint16_t v = key[i];
+                std::memcpy(bytes + 2 * i, &v, 2);
+            } else {
+                const uint32_t v = key[i];
+                std::memcpy(bytes + 4 * i, &v, 4);
+            }
+        }
+        for (std::size_t i = size; i < sizeof(bytes); i += size) {
+            std::memcpy(bytes + i, bytes, size);
+        }
+    }
+};
+
+using xor_fn = void (*)(uint8_t*, const uint8_t*, std::size_t, const uint8_t*, std::size_t) noexcept;
+using consume_fn = void (*)(uint8_t*, uint8_t*, std::size_t, const uint8_t*) noexcept;
+using equal_fn = bool (*)(const uint8_t*, const uint8_t*, std::size_t, const uint8_t*, std::size_t) noexcept;
+using mismatch_fn = std::size_t (*)(const uint8_t*, const uint8_t*, std::size_t, const uint8_t*, std::size_t) noexcept;
+
+// Portable kernels, for targets without a SIMD set here.
+
+[[maybe_unused]] void xor_generic(uint8_t* out, const uint8_t* in, std::size_t n, const uint8_t* ek, std::size_t p) noexcept {
+    std::size_t i = 0;
+    for (; n - i >= p; i += p) {
+        for (std::size_t j = 0; j < p; ++j) {
+            out[i + j] = in[i + j] ^ ek[j];
+        }
+    }
+    for (std::size_t j = 0; i < n; ++i, ++j) {
+        out[i] = in[i] ^ ek[j];
+    }
+}
+
+void consume_generic(uint8_t* out, uint8_t* in, std::size_t n, const uint8_t* key) noexcept {
+    for (std::size_t i = 0; i < n; ++i) {
+        out[i] = in[i] ^ key[i & 31];
+        in[i] = 0;
+    }
+    __asm__ __volatile__("" : : "r"(in) : "memory");
+}
+
+[[maybe_unused]] bool equal_generic(const uint8_t* a, const uint8_t* b, std::size_t n, const uint8_t* ek, std::size_t p) noexcept {
+    uint8_t diff = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        diff |= static_cast<uint8_t>(a[i] ^ ek[i & (p - 1)] ^ b[i]);
+    }
+    return diff == 0;
+}
+
+[[maybe_unused]] std::size_t mismatch_generic(const uint8_t* a, const uint8_t* b, std::size_t n,
+                                              const uint8_t* ek, std::size_t p) noexcept {
+    std::size_t i = 0;
+    while (i < n && static_cast<uint8_t>(a[i] ^ ek[i & (p - 1)]) == b[i]) {
+        ++i;
+    }
+    return i;
+}
+
+#if defined(OBF_LIB_X86)
+
+void xor_sse2(uint8_t* out, const uint8_t* in, std::size_t n, const uint8_t* ek, std::size_t p) noexcept {
+    const std::size_t m = p - 1;
+    __m128i k[8];
+    for (std::size_t j = 0; j < 8; ++j) {
+        k[j] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ek + ((16 * j) & m)));
+    }
+    std::size_t i = 0;
+    for (; n - i >= 128; i += 128) {
+        for (std::size_t j = 0; j < 8; ++j) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 16 * j));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 16 * j), _mm_xor_si128(v, k[j]));
+        }
+    }
+    for (; n - i >= 16; i += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_xor_si128(v, k[(i >> 4) & 7]));
+    }
+    for (; i < n; ++i) {
+        out[i] = in[i] ^ ek[i & m];
+    }
+}
+
+__attribute__((target("avx2")))
+void xor_avx2(uint8_t* out, const uint8_t* in, std::size_t n, const uint8_t* ek, std::size_t p) noexcept {
+    const std::size_t m = p - 1;
+    __m256i k[4];
+    for (std::size_t j = 0; j < 4; ++j) {
+        k[j] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ek + ((32 * j) & m)));
+    }
+    std::size_t i = 0;
+    for (; n - i >= 128; i += 128) {
+        const __m256i v0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        const __m256i v1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i + 32));
+        const __m256i v2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i + 64));
+        const __m256i v3 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i + 96));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_xor_si256(v0, k[0]));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i + 32), _mm256_xor_si256(v1, k[1]));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i + 64), _mm256_xor_si256(v2, k[2]));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i + 96), _mm256_xor_si256(v3, k[3]));
+    }
+    for (; n - i >= 32; i += 32) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_xor_si256(v, k[(i >> 5) & 3]));
+    }
+    for (; i < n; ++i) {
+        out[i] = in[i] ^ ek[i & m];
+    }
+}
+
+__attribute__((target("avx512f")))
+void xor_avx512(uint8_t* out, const uint8_t* in, std::size_t n, const uint8_t* ek, std::size_t p) noexcept {
+    const std::size_t m = p - 1;
+    __m512i k[4];
+    for (std::size_t j = 0; j < 4; ++j) {
+        k[j] = _mm512_loadu_si512(ek + ((64 * j) & m));
+    }
+    std::size_t i = 0;
+    for (; n - i >= 256; i += 256) {
+        for (std::size_t j = 0; j < 4; ++j) {
+            const __m512i v = _mm512_loadu_si512(in + i + 64 * j);
+            _mm512_storeu_si512(out + i + 64 * j, _mm512_xor_si512(v, k[j]));
+        }
+    }
+    for (; n - i >= 64; i += 64) {
+        _mm512_storeu_si512(out + i, _mm512_xor_si512(_mm512_loadu_si512(in + i), k[(i >> 6) & 3]));
+    }
+    for (; n - i >= 32; i += 32) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        const __m256i kv = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ek + (i & m)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_xor_si256(v, kv));
+    }
+    for (; i < n; ++i) {
+        out[i] = in[i] ^ ek[i & m];
+    }
+}
+
+void consume_sse2(uint8_t* out, uint8_t* in, std::size_t n, const uint8_t* key) noexcept {
+    const __m128i k0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(key));
+    const __m128i k1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(key + 16));
+    const __m128i zero = _mm_setzero_si128();
+    std::size_t i = 0;
+    for (; n - i >= 32; i += 32) {
+        const __m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        const __m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 16));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_xor_si128(v0, k0));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 16), _mm_xor_si128(v1, k1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(in + i), zero);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(in + i + 16), zero);
+    }
+    consume_generic(out + i, in + i, n - i, key);
+}
+
+__attribute__((target("avx2")))
+void consume_avx2(uint8_t* out, uint8_t* in, std::size_t n, const uint8_t* key) noexcept {
+    const __m256i k = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(key));
+    const __m256i zero = _mm256_setzero_si256();
+    std::size_t i = 0;
+    for (; n - i >= 32; i += 32) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_xor_si256(v, k));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(in + i), zero);
+    }
+    consume_generic(out + i, in + i, n - i, key);
+}
+
+bool equal_sse2(const uint8_t* a, const uint8_t* b, std::size_t n, const uint8_t* ek, std::size_t p) noexcept {
+    const std::size_t m = p - 1;
+    __m128i diff = _mm_setzero_si128();
+    std::size_t i = 0;
+    for (; n - i >= 16; i += 16) {
+        const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        const __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        const __m128i k = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ek + (i & m)));
+        diff = _mm_or_si128(diff, _mm_xor_si128(_mm_xor_si128(x, k), y));
+    }
+    const bool head = _mm_movemask_epi8(_mm_cmpeq_epi8(diff, _mm_setzero_si128())) == 0xffff;
+    uint8_t tail = 0;
+    for (; i < n; ++i) {
+        tail |= static_cast<uint8_t>(a[i] ^ ek[i & m] ^ b[i]);
+    }
+    return head & (tail == 0);
+}
+
+__attribute__((target("avx2")))
+bool equal_avx2(const uint8_t* a, const uint8_t* b, std::size_t n, const uint8_t* ek, std::size_t p) noexcept {
+    const std::size_t m = p - 1;
+    __m256i diff = _mm256_setzero_si256();
+    std::size_t i = 0;
+    for (; n - i >= 32; i += 32) {
+        const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        const __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        const __m256i k = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ek + (i & m)));
+        diff = _mm256_or_si256(diff, _mm256_xor_si256(_mm256_xor_si256(x, k), y));
+    }
+    const bool head = _mm256_testz_si256(diff, diff) != 0;
+    uint8_t tail = 0;
+    for (; i < n; ++i) {
+        tail |= static_cast<uint8_t>(a[i] ^ ek[i & m] ^ b[i]);
+    }
+    return head & (tail == 0);
+}
+
+std::size_t mismatch_sse2(const uint8_t* a, const uint8_t* b, std::size_t n, const uint8_t* ek,
+                          std::size_t p) noexcept {
+    const std::size_t m = p - 1;
+    std::size_t i = 0;
+    for (; n - i >= 16; i += 16) {
+        const __m128i x = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)),
+                                        _mm_loadu_si128(reinterpret_cast<const __m128i*>(ek + (i & m))));
+        const __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        const unsigned ne = ~static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(x, y))) & 0xffff;
+        if (ne != 0) {
+            return i + static_cast<std::size_t>(__builtin_ctz(ne));
+        }
+    }
+    while (i < n && static_cast<uint8_t>(a[i] ^ ek[i & m]) == b[i]) {
+        ++i;
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+std::size_t mismatch_avx2(const uint8_t* a, const uint8_t* b, std::size_t n, const uint8_t* ek,
+                          std::size_t p) noexcept {
+    const std::size_t m = p - 1;
+    std::size_t i = 0;
+    for (; n - i >= 32; i += 32) {
+        const __m256i x = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)),
+                                           _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ek + (i & m))));
+        const __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        const unsigned ne = ~static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y)));
+        if (ne != 0) {
+            return i + static_cast<std::size_t>(__builtin_ctz(ne));
+        }
+    }
+    while (i < n && static_cast<uint8_t>(a[i] ^ ek[i & m]) == b[i]) {
+        ++i;
+    }
+    return i;
+}
+
+#endif
+
+struct kernel_set {
+    const char* isa;
+    xor_fn xor_pattern;
+    consume_fn consume;
+    equal_fn equal;
+    mismatch_fn mismatch;
+};
+
+kernel_set pick() noexcept {
+#if defined(OBF_LIB_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return { "avx512f", xor_avx512, consume_avx2, equal_avx2, mismatch_avx2 };
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return { "avx2", xor_avx2, consume_avx2, equal_avx2, mismatch_avx2 };
+    }
+    return { "sse2", xor_sse2, consume_sse2, equal_sse2, mismatch_sse2 };
+#else
+    return { "generic", xor_generic, consume_generic, equal_generic, mismatch_generic };
+#endif
+}
+
+// Resolved on first call rather than during static initialization, so OBF_GLOBAL_EAGER
+// strings in other TUs can decrypt through the library from their own initializers.
+const kernel_set& kernels() noexcept {
+    static const kernel_set set = pick();
+    return set;
+}
+
+// Code units the kernels handle. The C ABI cannot constrain `unit` the way the header's
+// templates do, so every entry point checks it: any other width is a caller bug.
+bool valid_unit(std::size_t unit) noexcept {
+    return unit == 1 || unit == 2 || unit == 4;
+}
+
+}
+
+extern "C" {
+
+unsigned obf_abi_version(void) {
+    return OBF_LIB_ABI_VERSION;
+}
+
+const char* obf_kernel_isa(void) {
+    return kernels().isa;
+}
+
+void obf_xor_key_stream(void* out, const void* in, size_t n, size_t unit, const uint8_t key[32]) {
+    if (!valid_unit(unit)) {
+        return;
+    }
+    const pattern ek(key, unit);
+    kernels().xor_pattern(static_cast<uint8_t*>(out), static_cast<const uint8_t*>(in), n * unit, ek.bytes,
+                          ek.size);
+}
+
+void obf_xor_key_stream_consume(void* out, void* in, size_t n, const uint8_t key[32]) {
+    kernels().consume(static_cast<uint8_t*>(out), static_cast<uint8_t*>(in), n, key);
+}
+
+int obf_xor_key_equal(const void* cipher, const void* rhs, size_t n, size_t unit, const uint8_t key[32]) {
+    if (!valid_unit(unit)) {
+        return 0;
+    }
+    const pattern ek(key, unit);
+    return kernels().equal(static_cast<const uint8_t*>(cipher), static_cast<const uint8_t*>(rhs), n * unit,
+                           ek.bytes, ek.size);
+}
+
+size_t obf_xor_key_mismatch(const void* cipher, const void* rhs, size_t n, size_t unit, const uint8_t key[32]) {
+    if (!valid_unit(unit)) {
+        return 0;
+    }
+    const pattern ek(key, unit);
+    return kernels().mismatch(static_cast<const uint8_t*>(cipher), static_cast<const uint8_t*>(rhs), n * unit,
+                              ek.bytes, ek.size) / unit;
+}
+
+void obf_secure_wipe(void* p, size_t n) {
+    obff_internal::secure_wipe(p, n);
+}
+
+void obf_rolling_key(uint64_t seed, uint8_t key[32]) {
+    const auto k = obff_internal::make_rolling_key<32>(static_cast<std::size_t>(seed));
+    std::memcpy(key, k.data(), 32);
+}
+
+void obf_stream_key(uint64_t key, uint64_t position, uint8_t out[32]) {
+    const auto k = obff_internal::stream_key(key, position);
+    std::memcpy(out, k.data(), 32);
+}
+
+}
@@ -0,0 +1,52 @@
+/* C ABI of libobf, the optional precompiled home of the runtime kernels behind
+ * obfuscator.h. Define OBF_USE_LIB before including obfuscator.h and link libobf to
+ * have the header call these instead of compiling its own SIMD loops into every TU.
+ * The kernels pick the widest instruction set the CPU supports on first use.
+ *
+ * Keys are the library's 32-byte rolling keys. Strings are arrays of `unit`-byte code
+ * units (1, 2 or 4); code unit i is XORed with key byte i % 32, zero-extended. Any other
+ * unit is rejected: obf_xor_key_stream does nothing, obf_xor_key_equal and
+ * obf_xor_key_mismatch return 0.
+ * The ABI only grows; obf_abi_version() reports what the loaded library implements. */
+#ifndef OBF_LIB_H
+#define OBF_LIB_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define OBF_LIB_ABI_VERSION 1u
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+unsigned obf_abi_version(void);
+
+/* "avx512f", "avx2", "sse2" or "generic": the kernel set in use. */
+const char* obf_kernel_isa(void);
+
+/* out[i] = in[i] ^ key[i % 32] for n code units; out may equal in. */
+void obf_xor_key_stream(void* out, const void* in, size_t n, size_t unit, const uint8_t key[32]);
+
+/* Byte strings: out[i] = in[i] ^ key[i % 32] and in[i] = 0 in the same pass. */
+void obf_xor_key_stream_consume(void* out, void* in, size_t n, const uint8_t key[32]);
+
+/* Nonzero if cipher ^ key equals rhs over n code units, in time independent of where
+ * they differ. */
+int obf_xor_key_equal(const void* cipher, const void* rhs, size_t n, size_t unit, const uint8_t key[32]);
+
+/* Index of the first code unit where cipher ^ key differs from rhs, or n. */
+size_t obf_xor_key_mismatch(const void* cipher, const void* rhs, size_t n, size_t unit, const uint8_t key[32]);
+
+/* memset the optimizer may not drop. */
+void obf_secure_wipe(void* p, size_t n);
+
+/* The header's make_rolling_key<32>(seed) and stream_key(key, position). */
+void obf_rolling_key(uint64_t seed, uint8_t key[32]);
+void obf_stream_key(uint64_t key, uint64_t position, uint8_t out[32]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
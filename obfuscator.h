@@ -1,8 +1,43 @@
 #pragma once
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <array>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <new>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+#endif
+#if __has_include(<compare>)
+#include <compare>
+#endif
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <coroutine>
+#endif
+#if defined(OBF_PROFILE_GENERATE)
+#include <cstdio>
+#include <cstdlib>
+#endif
+#if defined(__unix__) || defined(__APPLE__)
+extern "C" {
+extern char** environ;
+}
+#endif
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(OBF_USE_LIB)
+#include "libobf/obf.h"
+#endif
 
 namespace obff_internal {
 
@@ -29,75 +64,1917 @@ constexpr auto make_rolling_key(std::size_t seed) noexcept {
     return key;
 }
 
+constexpr uint64_t block_seed(std::size_t seed, std::size_t block) noexcept {
+    return mix_seed(static_cast<uint64_t>(seed) ^ (0x9e3779b97f4a7c15ull * (block + 1)));
+}
+
+#if defined(OBF_USE_LIB)
+// With OBF_USE_LIB the kernels below forward to libobf for every string it handles:
+// 1-, 2- or 4-byte code units against a 32-byte key.
+template<typename CharT, std::size_t KeyLen>
+constexpr bool lib_kernel = KeyLen == 32 && (sizeof(CharT) == 1 || sizeof(CharT) == 2 || sizeof(CharT) == 4);
+#endif
 
-template<typename CharT, std::size_t N, std::size_t Seed>
-struct XorStringBase {
+// out[i] = in[i] ^ key[i % KeyLen]; out may equal in. Byte strings take the SIMD path.
+template<typename CharT, std::size_t KeyLen>
+inline void xor_key_stream(CharT* out, const CharT* in, std::size_t n,
+                           const std::array<uint8_t, KeyLen>& key) noexcept {
+#if defined(OBF_USE_LIB)
+    if constexpr (lib_kernel<CharT, KeyLen>) {
+        obf_xor_key_stream(out, in, n, sizeof(CharT), key.data());
+        return;
+    }
+#endif
+    std::size_t i = 0;
+#if !defined(OBF_USE_LIB) && (defined(__AVX2__) || defined(__SSE2__))
+    if constexpr (sizeof(CharT) == 1 && KeyLen == 32) {
+        auto* dst = reinterpret_cast<unsigned char*>(out);
+        const auto* src = reinterpret_cast<const unsigned char*>(in);
+#if defined(__AVX2__)
+        const __m256i k = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(key.data()));
+        for (; i + 128 <= n; i += 128) {
+            const __m256i v0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+            const __m256i v1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 32));
+            const __m256i v2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 64));
+            const __m256i v3 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 96));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_xor_si256(v0, k));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i + 32), _mm256_xor_si256(v1, k));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i + 64), _mm256_xor_si256(v2, k));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i + 96), _mm256_xor_si256(v3, k));
+        }
+        for (; i + 32 <= n; i += 32) {
+            const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_xor_si256(v, k));
+        }
+#elif defined(__SSE2__)
+        const __m128i k0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(key.data()));
+        const __m128i k1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(key.data() + 16));
+        for (; i + 32 <= n; i += 32) {
+            const __m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            const __m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 16));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_xor_si128(v0, k0));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 16), _mm_xor_si128(v1, k1));
+        }
+#endif
+    }
+#endif
+    for (; i + KeyLen <= n; i += KeyLen) {
+        for (std::size_t j = 0; j < KeyLen; ++j) {
+            out[i + j] = in[i + j] ^ static_cast<CharT>(key[j]);
+        }
+    }
+    for (; i < n; ++i) {
+        out[i] = in[i] ^ static_cast<CharT>(key[i % KeyLen]);
+    }
+}
+
+template<typename CharT, std::size_t KeyLen>
+inline void xor_key_stream(CharT* data, std::size_t n, const std::array<uint8_t, KeyLen>& key) noexcept {
+    xor_key_stream(data, data, n, key);
+}
+
+// out[i] = in[i] ^ key[i % 32] and in[i] = 0 in the same pass, so a plaintext source
+// buffer is consumed without a second sweep to wipe it.
+inline void xor_key_stream_consume(uint8_t* out, uint8_t* in, std::size_t n,
+                                   const std::array<uint8_t, 32>& key) noexcept {
+#if defined(OBF_USE_LIB)
+    obf_xor_key_stream_consume(out, in, n, key.data());
+#else
+    std::size_t i = 0;
+#if defined(__AVX2__)
+    const __m256i k = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(key.data()));
+    const __m256i zero = _mm256_setzero_si256();
+    for (; i + 32 <= n; i += 32) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_xor_si256(v, k));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(in + i), zero);
+    }
+#elif defined(__SSE2__)
+    const __m128i k0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(key.data()));
+    const __m128i k1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(key.data() + 16));
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 32 <= n; i += 32) {
+        const __m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        const __m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 16));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_xor_si128(v0, k0));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 16), _mm_xor_si128(v1, k1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(in + i), zero);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(in + i + 16), zero);
+    }
+#endif
+    for (; i < n; ++i) {
+        out[i] = in[i] ^ key[i % 32];
+        in[i] = 0;
+    }
+    __asm__ __volatile__("" : : "r"(in) : "memory");
+#endif
+}
+
+// memset the optimizer may not drop, even when the buffer is dead right afterwards.
+inline void secure_wipe(void* p, std::size_t n) noexcept {
+#if defined(OBF_USE_LIB)
+    obf_secure_wipe(p, n);
+#else
+    std::fill_n(static_cast<unsigned char*>(p), n, static_cast<unsigned char>(0));
+    __asm__ __volatile__("" : : "r"(p) : "memory");
+#endif
+}
+
+// Replaces process_secret() in a fork child that re-keys (obfuscator_fork.h), so parent
+// and siblings stop deriving the same nonces and keys. 0 until then.
+inline std::atomic<uint64_t> forked_secret{0};
+
+// Per-process seed for runtime-encrypted data: ASLR-dependent addresses and the clock,
+// folded through mix_seed. It only has to differ between runs, not resist an attacker
+// who can already read the process.
+inline uint64_t process_secret() noexcept {
+    if (const uint64_t forked = forked_secret.load(std::memory_order_relaxed)) {
+        return forked;
+    }
+    static const uint64_t secret = [] {
+        const int local = 0;
+        uint64_t z = static_cast<uint64_t>(reinterpret_cast<std::uintptr_t>(&local));
+        z = mix_seed(z ^ static_cast<uint64_t>(reinterpret_cast<std::uintptr_t>(&process_secret)));
+        const auto now = std::chrono::high_resolution_clock::now().time_since_epoch().count();
+        return mix_seed(z ^ static_cast<uint64_t>(now));
+    }();
+    return secret;
+}
+
+inline uint64_t next_nonce() noexcept {
+    static std::atomic<uint64_t> counter{0};
+    return counter.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Key for the data at `position` of a runtime stream (IPC messages, encrypted files).
+// The four key words come from independent mix_seed calls, so a key costs a few
+// nanoseconds instead of make_rolling_key's serial chain.
+inline std::array<uint8_t, 32> stream_key(uint64_t key, uint64_t position) noexcept {
+    const uint64_t base = mix_seed(key ^ position);
+    std::array<uint8_t, 32> out;
+    for (std::size_t j = 0; j < 4; ++j) {
+        const uint64_t word = mix_seed(base + 0x9e3779b97f4a7c15ull * (j + 1));
+        std::memcpy(out.data() + 8 * j, &word, sizeof(word));
+    }
+    return out;
+}
+
+// FNV-1a over the little-endian bytes of each code unit. The same function hashes the
+// plaintext at compile time and lookup keys at run time, so the two always agree.
+template<typename CharT>
+constexpr uint64_t fnv1a(const CharT* s, std::size_t n) noexcept {
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (std::size_t i = 0; i < n; ++i) {
+        const auto unit = static_cast<uint64_t>(static_cast<std::make_unsigned_t<CharT>>(s[i]));
+        for (std::size_t b = 0; b < sizeof(CharT); ++b) {
+            h ^= (unit >> (8 * b)) & 0xff;
+            h *= 0x100000001b3ull;
+        }
+    }
+    return h;
+}
+
+// Hash of every stride-th element of s[first, last) continuing from h, for seeds derived
+// from a literal. Unrelated to the fnv1a stored next to the ciphertext, which would
+// otherwise give the key away.
+template<typename CharT>
+constexpr uint64_t literal_hash(const CharT* s, std::size_t first, std::size_t last, uint64_t h,
+                                std::size_t stride = 1) noexcept {
+    for (std::size_t i = first; i < last; i += stride) {
+        h = (h ^ static_cast<uint64_t>(static_cast<std::make_unsigned_t<CharT>>(s[i]))) * 0x9e3779b97f4a7c15ull;
+        h ^= h >> 29;
+    }
+    return h;
+}
+
+// Seed for a literal's key stream taken from the literal itself (and an optional salt),
+// so every literal gets its own key wherever it is expanded. The n units include the
+// terminator; tools/obf_encrypt.cpp calls literal_seed_n on the strings it parses.
+template<typename CharT>
+constexpr std::size_t literal_seed_n(const CharT* s, std::size_t n, uint64_t salt = 0) noexcept {
+    return static_cast<std::size_t>(mix_seed(literal_hash(s, 0, n, n ^ salt)));
+}
+
+template<typename CharT, std::size_t N>
+constexpr std::size_t literal_seed(const CharT (&s)[N], uint64_t salt = 0) noexcept {
+    return literal_seed_n(s, N, salt);
+}
+
+// True if in[i] ^ key[i % KeyLen] == rhs[i] for all i < n, without materializing the
+// plaintext anywhere. Differences are OR-accumulated, so timing does not depend on
+// where the first mismatch is.
+template<typename CharT, std::size_t KeyLen>
+inline bool xor_key_equal(const CharT* in, const CharT* rhs, std::size_t n,
+                          const std::array<uint8_t, KeyLen>& key) noexcept {
+#if defined(OBF_USE_LIB)
+    if constexpr (lib_kernel<CharT, KeyLen>) {
+        return obf_xor_key_equal(in, rhs, n, sizeof(CharT), key.data()) != 0;
+    }
+#endif
+    std::size_t i = 0;
+#if !defined(OBF_USE_LIB) && (defined(__AVX2__) || defined(__SSE2__))
+    if constexpr (sizeof(CharT) == 1 && KeyLen == 32) {
+        const auto* a = reinterpret_cast<const unsigned char*>(in);
+        const auto* b = reinterpret_cast<const unsigned char*>(rhs);
+#if defined(__AVX2__)
+        const __m256i k = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(key.data()));
+        __m256i diff = _mm256_setzero_si256();
+        for (; i + 32 <= n; i += 32) {
+            const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+            const __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+            diff = _mm256_or_si256(diff, _mm256_xor_si256(_mm256_xor_si256(x, k), y));
+        }
+        if (!_mm256_testz_si256(diff, diff)) {
+            return false;
+        }
+#else
+        const __m128i k0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(key.data()));
+        const __m128i k1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(key.data() + 16));
+        __m128i diff = _mm_setzero_si128();
+        for (; i + 32 <= n; i += 32) {
+            const __m128i x0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+            const __m128i x1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i + 16));
+            const __m128i y0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+            const __m128i y1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i + 16));
+            diff = _mm_or_si128(diff, _mm_xor_si128(_mm_xor_si128(x0, k0), y0));
+            diff = _mm_or_si128(diff, _mm_xor_si128(_mm_xor_si128(x1, k1), y1));
+        }
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(diff, _mm_setzero_si128())) != 0xffff) {
+            return false;
+        }
+#endif
+    }
+#endif
+    CharT diff{};
+    for (; i < n; ++i) {
+        diff |= static_cast<CharT>(in[i] ^ static_cast<CharT>(key[i % KeyLen]) ^ rhs[i]);
+    }
+    return diff == CharT{};
+}
+
+// Index of the first i < n where in[i] ^ key[i % KeyLen] != rhs[i], or n. Used for
+// ordering, which has to find the first difference anyway.
+template<typename CharT, std::size_t KeyLen>
+inline std::size_t xor_key_mismatch(const CharT* in, const CharT* rhs, std::size_t n,
+                                    const std::array<uint8_t, KeyLen>& key) noexcept {
+#if defined(OBF_USE_LIB)
+    if constexpr (lib_kernel<CharT, KeyLen>) {
+        return obf_xor_key_mismatch(in, rhs, n, sizeof(CharT), key.data());
+    }
+#endif
+    std::size_t i = 0;
+#if !defined(OBF_USE_LIB) && defined(__SSE2__)
+    if constexpr (sizeof(CharT) == 1 && KeyLen == 32) {
+        const auto* a = reinterpret_cast<const unsigned char*>(in);
+        const auto* b = reinterpret_cast<const unsigned char*>(rhs);
+        for (; i + 16 <= n; i += 16) {
+            const __m128i x = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)),
+                                            _mm_loadu_si128(reinterpret_cast<const __m128i*>(key.data() + (i & 31))));
+            const __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+            const unsigned ne = ~static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(x, y))) & 0xffff;
+            if (ne != 0) {
+                return i + static_cast<std::size_t>(__builtin_ctz(ne));
+            }
+        }
+    }
+#endif
+    for (; i < n; ++i) {
+        if (static_cast<CharT>(in[i] ^ static_cast<CharT>(key[i % KeyLen])) != rhs[i]) {
+            break;
+        }
+    }
+    return i;
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+// True if the environment entry e is "<name>=...", name being the n bytes of cipher ^ key.
+// The byte loop stops at e's terminator, which never matches a name byte. Names of 16
+// bytes and more compare whole chunks with SSE2, after strnlen has shown that e holds at
+// least n + 1 bytes, so no load reaches past the entry.
+inline bool env_entry_matches(const char* e, const char* cipher, const uint8_t* key,
+                              std::size_t n) noexcept {
+    std::size_t i = 0;
+#if defined(__SSE2__)
+    if (n >= 16 && strnlen(e, n + 1) != n + 1) {
+        return false;
+    }
+    for (; i + 16 <= n; i += 16) {
+        const __m128i expect = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(cipher + i)),
+                                             _mm_loadu_si128(reinterpret_cast<const __m128i*>(key + (i & 31))));
+        const __m128i entry = _mm_loadu_si128(reinterpret_cast<const __m128i*>(e + i));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(entry, expect)) != 0xffff) {
+            return false;
+        }
+    }
+#endif
+    for (; i < n; ++i) {
+        if (e[i] != static_cast<char>(cipher[i] ^ key[i & 31])) {
+            return false;
+        }
+    }
+    return e[n] == '=';
+}
+#endif
+
+// Pulls [p, p + bytes) towards L1 ahead of use; write intent, since decrypt() stores.
+inline void prefetch_range(const void* p, std::size_t bytes) noexcept {
+    const auto* c = static_cast<const char*>(p);
+    for (std::size_t off = 0; off < bytes; off += 64) {
+        __builtin_prefetch(c + off, 1, 3);
+    }
+    __builtin_prefetch(c + bytes - 1, 1, 3);
+}
+
+// While encrypted, the state also counts the threads reading the ciphertext in place
+// (read_storage), in steps of state_reader; decrypt() waits for the count to drop to zero.
+enum : uint8_t { state_encrypted = 0, state_busy = 1, state_decrypted = 2, state_reader = 4 };
+
+inline void cpu_relax() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+// Runs xor_in_place exactly once across threads. The plaintext is published with a
+// release store, so any thread that observes state_decrypted sees the finished string.
+template<typename F>
+inline void decrypt_once(std::atomic<uint8_t>& state, F&& xor_in_place) noexcept {
+    uint8_t s = state.load(std::memory_order_acquire);
+    while (s != state_decrypted) {
+        if (s == state_encrypted) {
+            if (state.compare_exchange_weak(s, state_busy, std::memory_order_acquire)) {
+                xor_in_place();
+                state.store(state_decrypted, std::memory_order_release);
+                return;
+            }
+            continue;
+        }
+        cpu_relax();  // another decrypt() or ciphertext readers
+        s = state.load(std::memory_order_acquire);
+    }
+}
+
+// Runs read(encrypted) against the storage without taking ownership of it. Ciphertext is
+// read with the reader count raised, so no decrypt() can start rewriting it meanwhile;
+// plaintext no longer changes (wipes must not race readers anyway). A decrypt() already
+// running is waited out.
+template<typename F>
+inline void read_storage(std::atomic<uint8_t>& state, F&& read) noexcept {
+    uint8_t s = state.load(std::memory_order_acquire);
+    for (;;) {
+        if (s == state_decrypted) {
+            read(false);
+            return;
+        }
+        if (s % state_reader == state_encrypted && s <= 0xff - state_reader) {
+            if (state.compare_exchange_weak(s, static_cast<uint8_t>(s + state_reader), std::memory_order_acquire)) {
+                read(true);
+                state.fetch_sub(state_reader, std::memory_order_release);
+                return;
+            }
+            continue;
+        }
+        cpu_relax();
+        s = state.load(std::memory_order_acquire);
+    }
+}
+
+#ifndef OBF_MAX_SITES
+#define OBF_MAX_SITES 65536
+#endif
+
+// Which strings are plaintext right now, as one global bitset indexed by a dense slot
+// that each string takes on its first decrypt. Slots are interleaved across 64-byte
+// shards, so strings decrypting at the same time rarely touch the same line. The
+// per-object state byte stays authoritative for the decrypt fast path; the bitset mirrors
+// it so auditing and selective wipes only touch what is actually exposed.
+struct tracked_site {
+    void* object;
+    void (*reencrypt)(void*) noexcept;
+};
+
+struct alignas(64) bitmap_shard {
+    std::atomic<uint64_t> words[8];
+};
+
+struct state_tracker {
+    static constexpr std::size_t capacity = OBF_MAX_SITES;
+    static constexpr std::size_t shard_bits = 8 * 64;
+    static constexpr std::size_t shard_count = (capacity + shard_bits - 1) / shard_bits;
+    static constexpr uint32_t untracked = 0xffffffffu;
+
+    static constexpr std::size_t chunk_sites = 1024;
+    static constexpr std::size_t chunk_count = (capacity + chunk_sites - 1) / chunk_sites;
+
+    std::atomic<uint32_t> next_slot{0};
+    bitmap_shard shards[shard_count];
+    // Site entries come in chunks allocated as slots are handed out, so a program pays
+    // for the strings it decrypts rather than for OBF_MAX_SITES of them.
+    std::atomic<tracked_site*> chunks[chunk_count];
+
+    // Null if the chunk cannot be allocated; that slot then goes untracked.
+    tracked_site* reserve(uint32_t slot) noexcept {
+        std::atomic<tracked_site*>& chunk = chunks[slot / chunk_sites];
+        tracked_site* c = chunk.load(std::memory_order_acquire);
+        if (c == nullptr) {
+            auto* fresh = new (std::nothrow) tracked_site[chunk_sites];
+            if (fresh == nullptr) {
+                return nullptr;
+            }
+            if (chunk.compare_exchange_strong(c, fresh, std::memory_order_acq_rel)) {
+                c = fresh;
+            } else {
+                delete[] fresh;
+            }
+        }
+        return c + slot % chunk_sites;
+    }
+
+    // Only for slots whose bit is (or was) set, which implies a reserved entry.
+    const tracked_site& site(uint32_t slot) const noexcept {
+        return chunks[slot / chunk_sites].load(std::memory_order_acquire)[slot % chunk_sites];
+    }
+
+    std::atomic<uint64_t>& word(uint32_t slot, uint64_t& bit) noexcept {
+        const uint32_t index = slot / shard_count;
+        bit = uint64_t{1} << (index % 64);
+        return shards[slot % shard_count].words[index / 64];
+    }
+
+    static constexpr uint32_t slot_of(std::size_t shard, std::size_t word, unsigned bit) noexcept {
+        return static_cast<uint32_t>((word * 64 + bit) * shard_count + shard);
+    }
+
+    // Index of slot's word in a flat copy of the shards, such as a fork snapshot.
+    static constexpr std::size_t flat_word(uint32_t slot) noexcept {
+        return slot % shard_count * 8 + slot / shard_count / 64;
+    }
+};
+
+inline state_tracker tracker;
+
+template<typename XS>
+void reencrypt_site(void* object) noexcept {
+    static_cast<XS*>(object)->reencrypt();
+}
+
+// slot holds 0 until the first decrypt and slot + 1 afterwards.
+inline void track_decrypted(uint32_t& slot, void* object, void (*reencrypt)(void*) noexcept) noexcept {
+    if (slot == 0) {
+        const uint32_t s = tracker.next_slot.fetch_add(1, std::memory_order_relaxed);
+        tracked_site* site = s < state_tracker::capacity ? tracker.reserve(s) : nullptr;
+        if (site == nullptr) {
+            slot = state_tracker::untracked;
+            return;
+        }
+        *site = { object, reencrypt };
+        slot = s + 1;
+    }
+    if (slot != state_tracker::untracked) {
+        uint64_t bit;
+        tracker.word(slot - 1, bit).fetch_or(bit, std::memory_order_release);
+    }
+}
+
+inline void track_wiped(uint32_t slot) noexcept {
+    if (slot != 0 && slot != state_tracker::untracked) {
+        uint64_t bit;
+        tracker.word(slot - 1, bit).fetch_and(~bit, std::memory_order_release);
+    }
+}
+
+// Set in a fork child by obfuscator_fork.h: the tracker bits as they were at fork(), in
+// flat_word order. Strings in it still share their pages with the parent.
+inline const uint64_t* fork_inherited = nullptr;
+
+// Whether a destructor has anything to wipe. Outside fork children, always. In a child,
+// only plaintext the child decrypted itself: zeroing ciphertext or the parent's plaintext
+// would copy each page just to clear the child's private copy of it.
+inline bool exit_wipe_needed(uint32_t slot) noexcept {
+    if (fork_inherited == nullptr || slot == state_tracker::untracked) {
+        return true;
+    }
+    if (slot == 0) {
+        return false;
+    }
+    uint64_t bit;
+    const bool plaintext = (tracker.word(slot - 1, bit).load(std::memory_order_relaxed) & bit) != 0;
+    return plaintext && (fork_inherited[state_tracker::flat_word(slot - 1)] & bit) == 0;
+}
+
+// With OBF_REGISTRY defined, every OBF* site links itself into site_list during static
+// initialization (one pointer push per site), so the whole set can be warmed up front.
+// It is opt-in because it also hands a reverse engineer a list of every string.
+struct site_entry {
+    void* object;
+    void (*decrypt)(void*) noexcept;
+    site_entry* next;
+};
+
+inline std::atomic<site_entry*> site_list{nullptr};
+
+template<typename XS>
+void decrypt_site(void* object) noexcept {
+    static_cast<XS*>(object)->decrypt();
+}
+
+inline bool register_site(site_entry& entry, void* object, void (*decrypt)(void*) noexcept) noexcept {
+    entry.object = object;
+    entry.decrypt = decrypt;
+    entry.next = site_list.load(std::memory_order_relaxed);
+    while (!site_list.compare_exchange_weak(entry.next, &entry, std::memory_order_release,
+                                            std::memory_order_relaxed)) {
+    }
+    return true;
+}
+
+// Tag is a local struct whose static object() returns the site's storage.
+template<typename Tag, typename XS>
+struct site_registrar {
+    static inline site_entry entry{};
+    static inline const bool registered = register_site(entry, Tag::object(), &decrypt_site<XS>);
+};
+
+// Profile-guided per-site policies. A site's ID hashes the file and line of its macro
+// and a hash of its literal, so sites sharing a line stay apart;
+// an OBF_PROFILE_GENERATE build writes per-site access counts and first-use times at
+// exit, tools/obf_profile.cpp turns them into a header of OBF_POLICY(id, policy) lines,
+// and an OBF_PROFILE_USE="that/header.h" build decrypts each site according to it:
+//   lazy  - decrypt on first use (the default without a profile)
+//   eager - decrypt during static initialization, off the first request's path
+//   hot   - eager, plus an inline already-decrypted check with the slow path out of line
+//   cold  - the whole decrypt call out of line in .text.unlikely, smallest call site
+constexpr uint64_t site_id(const char* file, unsigned line, uint64_t literal) noexcept {
+    std::size_t n = 0;
+    while (file[n] != '\0') {
+        ++n;
+    }
+    return mix_seed(mix_seed(fnv1a(file, n) ^ line) ^ literal);
+}
+
+#define OBF_SITE_ID(literal) (obff_internal::site_id(__FILE__, __LINE__, (literal)))
+// The plaintext hash OBF_CIPHER carries, so a site keeps its ID through tools/obf_encrypt.
+#define OBF_STR_SITE_ID(str) OBF_SITE_ID(obff_internal::fnv1a(str, sizeof(str) / sizeof(str[0]) - 1))
+
+enum class site_policy : uint8_t { lazy, eager, hot, cold };
+
+#if defined(OBF_PROFILE_USE)
+#ifndef OBF_UNPROFILED_POLICY
+#define OBF_UNPROFILED_POLICY cold
+#endif
+#else
+#ifndef OBF_UNPROFILED_POLICY
+#define OBF_UNPROFILED_POLICY lazy
+#endif
+#endif
+
+template<uint64_t Id>
+struct site_policy_of {
+    static constexpr site_policy value = site_policy::OBF_UNPROFILED_POLICY;
+};
+
+#if defined(OBF_PROFILE_USE)
+#define OBF_POLICY(id, policy) \
+    template<> struct site_policy_of<id> { static constexpr site_policy value = site_policy::policy; };
+#include OBF_PROFILE_USE
+#undef OBF_POLICY
+#endif
+
+#if defined(__GNUC__)
+#define OBF_COLD __attribute__((cold, noinline))
+#elif defined(_MSC_VER)
+#define OBF_COLD __declspec(noinline)
+#else
+#define OBF_COLD
+#endif
+
+// Tag is a local struct whose static get() returns the site's storage.
+template<typename Tag>
+OBF_COLD auto* decrypt_cold() noexcept {
+    return Tag::get().decrypt();
+}
+
+template<typename Tag>
+struct eager_site {
+    static inline const bool done = (Tag::get().decrypt(), true);
+};
+
+template<site_policy P, typename Tag>
+auto* site_decrypt() noexcept {
+    auto& xs = Tag::get();
+    if constexpr (P == site_policy::eager) {
+        (void)eager_site<Tag>::done;
+        return xs.decrypt();
+    } else if constexpr (P == site_policy::hot) {
+        (void)eager_site<Tag>::done;
+        if (__builtin_expect(xs.state.load(std::memory_order_acquire) == state_decrypted, 1)) {
+            return const_cast<typename std::remove_reference_t<decltype(xs)>::char_type*>(xs.c_str());
+        }
+        return decrypt_cold<Tag>();
+    } else if constexpr (P == site_policy::cold) {
+        return decrypt_cold<Tag>();
+    } else {
+        return xs.decrypt();
+    }
+}
+
+#if defined(OBF_PROFILE_GENERATE)
+// One per site, constant-initialized; linked into profile_list on its first hit.
+struct site_profile {
+    uint64_t id;
+    const char* file;
+    unsigned line;
+    std::atomic<uint64_t> count{0};
+    int64_t first_use_ns = 0;
+    site_profile* next = nullptr;
+
+    constexpr site_profile(uint64_t id_, const char* file_, unsigned line_) noexcept
+        : id(id_), file(file_), line(line_) {}
+
+    void hit() noexcept;
+};
+
+inline std::atomic<site_profile*> profile_list{nullptr};
+
+inline void site_profile::hit() noexcept {
+    if (count.fetch_add(1, std::memory_order_relaxed) != 0) {
+        return;
+    }
+    first_use_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now().time_since_epoch()).count();
+    next = profile_list.load(std::memory_order_relaxed);
+    while (!profile_list.compare_exchange_weak(next, this, std::memory_order_release,
+                                               std::memory_order_relaxed)) {
+    }
+}
+
+// Appends this run's profile to $OBF_PROFILE_FILE (default obf.profile) at exit, one
+// "<id> <count> <first-use ns> <line> <file>" line per site that was used.
+struct profile_writer {
+    ~profile_writer() {
+        const char* path = std::getenv("OBF_PROFILE_FILE");
+        std::FILE* out = std::fopen(path != nullptr ? path : "obf.profile", "a");
+        if (out == nullptr) {
+            return;
+        }
+        std::fputs("# run\n", out);
+        for (auto* p = profile_list.load(std::memory_order_acquire); p != nullptr; p = p->next) {
+            std::fprintf(out, "%016llx %llu %lld %u %s\n", static_cast<unsigned long long>(p->id),
+                         static_cast<unsigned long long>(p->count.load(std::memory_order_relaxed)),
+                         static_cast<long long>(p->first_use_ns), p->line, p->file);
+        }
+        std::fclose(out);
+    }
+};
+
+inline profile_writer profile_dump;
+
+#define OBF_PROFILE_HIT(id) \
+    static obff_internal::site_profile obf_profile{id, __FILE__, __LINE__}; \
+    obf_profile.hit();
+#else
+#define OBF_PROFILE_HIT(id)
+#endif
+
+// Body of the decrypting macros: returns the plaintext pointer per the site's policy.
+#if defined(OBF_PROFILE_USE)
+#define OBF_SITE_DECRYPT(xs, id) \
+    OBF_PROFILE_HIT(id) \
+    struct obf_tag { static auto& get() noexcept { return xs; } }; \
+    return obff_internal::site_decrypt<obff_internal::site_policy_of<(id)>::value, obf_tag>();
+#else
+#define OBF_SITE_DECRYPT(xs, id) \
+    OBF_PROFILE_HIT(id) \
+    return xs.decrypt();
+#endif
+
+#if defined(OBF_REGISTRY)
+#define OBF_SITE(xs) \
+    struct obf_site { static void* object() noexcept { return &xs; } }; \
+    (void)obff_internal::site_registrar<obf_site, decltype(xs)>::registered;
+#else
+#define OBF_SITE(xs)
+#endif
+
+
+// Tags ciphertext produced ahead of time by tools/obf_encrypt.cpp (see OBF_CIPHER).
+struct preencrypted_t {
+    explicit preencrypted_t() = default;
+};
+
+inline constexpr preencrypted_t preencrypted{};
+
+// Everything of a string that does not depend on its seed. Literals get seeds of their
+// own, so the code lives here, instantiated once per character type and length, and
+// XorStringStorage only hands it the key stream.
+template<typename CharT, std::size_t N>
+struct XorStringCore {
+    using char_type = CharT;
     static constexpr std::size_t KeyLen = 32;
+    static constexpr std::size_t Length = N;
+    using key_type = std::array<uint8_t, KeyLen>;
     alignas(16) std::array<CharT, N> data{};
-    bool decrypted = false;
-    static constexpr auto key_stream = make_rolling_key<KeyLen>(Seed);
+    mutable std::atomic<uint8_t> state{state_encrypted};
+    uint32_t slot = 0;
+    // FNV-1a of the plaintext without its terminator, for obf::hash.
+    uint64_t hash = 0;
 
-    constexpr XorStringBase(const CharT (&input)[N]) {
+    constexpr XorStringCore(const CharT (&input)[N], const key_type& key) : hash(fnv1a(input, N - 1)) {
         for (std::size_t i = 0; i < N; ++i) {
-            data[i] = input[i] ^ static_cast<CharT>(key_stream[i % KeyLen]);
+            data[i] = input[i] ^ static_cast<CharT>(key[i % KeyLen]);
         }
     }
 
-    CharT* decrypt() noexcept {
-        if (!decrypted) {
-            for (std::size_t i = 0; i < N; ++i) {
-                data[i] ^= static_cast<CharT>(key_stream[i % KeyLen]);
-            }
-            decrypted = true;
+    // Ciphertext and hash computed outside the compiler; no constant evaluation of either.
+    constexpr XorStringCore(preencrypted_t, uint64_t plain_hash, const std::array<CharT, N>& cipher)
+        : data(cipher), hash(plain_hash) {}
+
+    const CharT* c_str() const noexcept {
+        return state.load(std::memory_order_acquire) == state_decrypted ? data.data() : nullptr;
+    }
+
+    // Zeroes the storage, plaintext or ciphertext, for good: the string reads back empty
+    // from then on. reencrypt() drops the plaintext but keeps the string usable.
+    OBF_COLD void zeroize() noexcept {
+        auto* p = reinterpret_cast<char*>(data.data());
+        std::fill(data.begin(), data.end(), CharT{0});
+        __builtin___clear_cache(p, p + sizeof(CharT) * N);
+        state.store(state_decrypted, std::memory_order_release);
+        track_wiped(slot);
+    }
+
+    // The exit-time wipe of XorString / XorWString. Out of line, as are zeroize and reencrypt_with,
+    // so each literal's destructor and tracker hook is a single call.
+    OBF_COLD void exit_wipe() noexcept {
+        if (exit_wipe_needed(slot)) {
+            zeroize();
         }
+    }
+
+protected:
+    // First decrypt, out of line; decrypt() checks for plaintext first. self and reencrypt
+    // are what the tracker calls to re-encrypt the full object.
+    OBF_COLD CharT* decrypt_with(const key_type& key, void* self, void (*reencrypt)(void*) noexcept) noexcept {
+        decrypt_once(state, [&] {
+            xor_key_stream(data.data(), N, key);
+            track_decrypted(slot, self, reencrypt);
+        });
         return data.data();
     }
 
-    const CharT* c_str() const noexcept {
-        return decrypted ? data.data() : nullptr;
+    bool equals_with(const key_type& key, std::basic_string_view<CharT> rhs) const noexcept {
+        if (rhs.size() != N - 1) {
+            return false;
+        }
+        bool eq = false;
+        read_storage(state, [&](bool encrypted) {
+            eq = encrypted ? xor_key_equal(data.data(), rhs.data(), N - 1, key)
+                           : std::equal(rhs.begin(), rhs.end(), data.data());
+        });
+        return eq;
     }
 
-    void zeroize() noexcept {
+    int compare_with(const key_type& stream, std::basic_string_view<CharT> rhs) const noexcept {
+        static constexpr key_type no_key{};
+        const std::size_t n = std::min(N - 1, rhs.size());
+        int r = 0;
+        read_storage(state, [&](bool encrypted) {
+            const auto& key = encrypted ? stream : no_key;
+            const std::size_t i = xor_key_mismatch(data.data(), rhs.data(), n, key);
+            if (i < n) {
+                const CharT c = data[i] ^ static_cast<CharT>(key[i % KeyLen]);
+                r = std::char_traits<CharT>::lt(c, rhs[i]) ? -1 : 1;
+            } else {
+                r = N - 1 < rhs.size() ? -1 : N - 1 > rhs.size() ? 1 : 0;
+            }
+        });
+        return r;
+    }
 
-        volatile auto* p = data.data();
-        std::fill(data.begin(), data.end(), CharT{0});
-        __builtin___clear_cache(reinterpret_cast<char*>(p), reinterpret_cast<char*>(p) + sizeof(CharT) * N);
+    void decrypt_range_with(const key_type& key, CharT* out, std::size_t first, std::size_t last) const noexcept {
+        read_storage(state, [&](bool encrypted) {
+            if (encrypted) {
+                xor_key_stream(out + first, data.data() + first, last - first, key);
+            } else {
+                std::copy(data.data() + first, data.data() + last, out + first);
+            }
+        });
+    }
+
+    OBF_COLD void reencrypt_with(const key_type& key) noexcept {
+        if (state.load(std::memory_order_acquire) == state_decrypted) {
+            xor_key_stream(data.data(), N, key);
+            state.store(state_encrypted, std::memory_order_release);
+            track_wiped(slot);
+        }
+    }
+};
+
+template<typename CharT, std::size_t N, std::size_t Seed>
+struct XorStringStorage : XorStringCore<CharT, N> {
+    using core = XorStringCore<CharT, N>;
+    using core::KeyLen;
+    static constexpr std::size_t seed = Seed;
+    static constexpr auto key_stream = make_rolling_key<KeyLen>(Seed);
+
+    constexpr XorStringStorage(const CharT (&input)[N]) : core(input, key_stream) {}
+
+    constexpr XorStringStorage(preencrypted_t p, uint64_t plain_hash, const std::array<CharT, N>& cipher)
+        : core(p, plain_hash, cipher) {}
+
+    CharT* decrypt() noexcept {
+        if (__builtin_expect(this->state.load(std::memory_order_acquire) == state_decrypted, 1)) {
+            return this->data.data();
+        }
+        return this->decrypt_with(key_stream, this, &reencrypt_site<XorStringStorage>);
+    }
+
+    // Writes the N plaintext characters into out without decrypting the stored copy.
+    void decrypt_to(CharT* out) const noexcept {
+        this->decrypt_range_with(key_stream, out, 0, N);
+    }
+
+    // Compares the plaintext (without terminator) against rhs straight from the
+    // ciphertext; nothing is decrypted.
+    bool equals(std::basic_string_view<CharT> rhs) const noexcept {
+        return this->equals_with(key_stream, rhs);
+    }
+
+    // Three-way comparison of the plaintext (without terminator) with rhs, in the order of
+    // std::char_traits<CharT>; the same no-decrypt path as equals().
+    int compare(std::basic_string_view<CharT> rhs) const noexcept {
+        return this->compare_with(key_stream, rhs);
+    }
+
+    // Plaintext of [first, last) into out + first. first must be a multiple of KeyLen.
+    void decrypt_range_to(CharT* out, std::size_t first, std::size_t last) const noexcept {
+        this->decrypt_range_with(key_stream, out, first, last);
+    }
+
+    // Issue this a few statements before decrypt() to hide the miss on the storage,
+    // the state byte and the key stream.
+    void prefetch() const noexcept {
+        prefetch_range(this->data.data(), sizeof(this->data));
+        __builtin_prefetch(&this->state, 1, 3);
+        __builtin_prefetch(key_stream.data(), 0, 3);
+    }
+
+    // Back to ciphertext; the next decrypt() starts over. Must not race with readers.
+    void reencrypt() noexcept {
+        this->reencrypt_with(key_stream);
+    }
+};
+
+template<typename CharT, std::size_t N, std::size_t Seed>
+std::true_type is_xor_string_test(const XorStringStorage<CharT, N, Seed>*);
+std::false_type is_xor_string_test(const void*);
+
+template<typename T>
+constexpr bool is_xor_string_v = decltype(is_xor_string_test(static_cast<const T*>(nullptr)))::value;
+
+// No default Seed: one shared by every literal would give them all the same key stream.
+// The macros pass literal_seed(str). Each literal is a type of its own, so these stay
+// one thin layer over XorStringStorage.
+template<std::size_t N, std::size_t Seed>
+struct XorString : XorStringStorage<char, N, Seed> {
+    using XorStringStorage<char, N, Seed>::XorStringStorage;
+    ~XorString() {
+        this->exit_wipe();
+    }
+};
+
+template<std::size_t N, std::size_t Seed>
+struct XorWString : XorStringStorage<wchar_t, N, Seed> {
+    using XorStringStorage<wchar_t, N, Seed>::XorStringStorage;
+    ~XorWString() {
+        this->exit_wipe();
     }
+};
+
+// No destructor, so a namespace-scope instance is constant-initialized with no guard
+// and no exit-time registration: see OBF_GLOBAL. Wipe with zeroize() when done. There is
+// no default Seed: a global is an inline variable shared by every TU, so its seed must
+// not depend on where it is expanded (OBF_GLOBAL uses literal_seed).
+template<std::size_t N, std::size_t Seed>
+struct XorGlobalString : XorStringStorage<char, N, Seed> {
+    using base = XorStringStorage<char, N, Seed>;
+    constexpr XorGlobalString(const char (&s)[N]) : base(s) {}
+};
 
-    ~XorStringBase() { zeroize(); }
+template<std::size_t N, std::size_t Seed>
+struct XorGlobalWString : XorStringStorage<wchar_t, N, Seed> {
+    using base = XorStringStorage<wchar_t, N, Seed>;
+    constexpr XorGlobalWString(const wchar_t (&s)[N]) : base(s) {}
 };
 
 
-template<std::size_t N, std::size_t Seed = __LINE__>
-struct XorString : XorStringBase<char, N, Seed> {
-    using base = XorStringBase<char, N, Seed>;
-    constexpr XorString(const char (&s)[N]) : base(s) {}
+// Large literals are encrypted in independently keyed blocks. Every block is its own
+// constant evaluation, so compile-time work grows linearly and no single evaluation
+// comes near -fconstexpr-steps / -fconstexpr-ops-limit / -fconstexpr-loop-limit.
+// Lit is a type whose static constexpr get() returns the literal (see OBF_LARGE).
+template<typename CharT, std::size_t BlockLen>
+struct CipherBlock {
+    CharT v[BlockLen];
 };
 
-template<std::size_t N, std::size_t Seed = __LINE__>
-struct XorWString : XorStringBase<wchar_t, N, Seed> {
-    using base = XorStringBase<wchar_t, N, Seed>;
-    constexpr XorWString(const wchar_t (&s)[N]) : base(s) {}
+constexpr std::size_t large_block_len = 4096;
+
+constexpr std::size_t large_seed_stride = 32;
+
+// Default seed of a large literal: its length and a hash of every 32nd element plus the
+// last few of each block, so every blob gets its own key stream. Hashing all of it would
+// double the compile time; two blobs of one length that differ only between samples
+// share a key stream, and want OBF_LARGE_SEED.
+template<typename CharT, typename Lit>
+struct large_literal_seed {
+    static constexpr std::size_t N = sizeof(Lit::get()) / sizeof(CharT);
+    static constexpr std::size_t Blocks = (N + large_block_len - 1) / large_block_len;
+
+    template<std::size_t B>
+    static constexpr std::size_t last = std::min(N, (B + 1) * large_block_len);
+
+    template<std::size_t B>
+    static constexpr uint64_t sampled = literal_hash(Lit::get(), B * large_block_len, last<B>, B, large_seed_stride);
+
+    template<std::size_t B>
+    static constexpr uint64_t block_hash =
+        literal_hash(Lit::get(), last<B> - std::min<std::size_t>(16, last<B> - B * large_block_len), last<B>, sampled<B>);
+
+    template<std::size_t... Bs>
+    static constexpr std::size_t fold(std::index_sequence<Bs...>) noexcept {
+        uint64_t h = N;
+        ((h = mix_seed(h ^ block_hash<Bs>)), ...);
+        return static_cast<std::size_t>(h);
+    }
+
+    static constexpr std::size_t value = fold(std::make_index_sequence<Blocks>{});
 };
 
+template<typename CharT, typename Lit, std::size_t Seed>
+struct XorLargeStringBase {
+    using char_type = CharT;
+    static constexpr std::size_t KeyLen = 32;
+    static constexpr std::size_t BlockLen = large_block_len;
+    static constexpr std::size_t N = sizeof(Lit::get()) / sizeof(CharT);
+    static constexpr std::size_t Length = N;
+    static constexpr std::size_t Blocks = (N + BlockLen - 1) / BlockLen;
+    using block_type = CipherBlock<CharT, BlockLen>;
+
+    template<std::size_t B>
+    static constexpr block_type encrypt_block() noexcept {
+        block_type out{};
+        const auto key = make_rolling_key<KeyLen>(block_seed(Seed, B));
+        // Raw copies: std::array::operator[] calls dominate constexpr evaluation cost.
+        uint8_t k[KeyLen]{};
+        for (std::size_t j = 0; j < KeyLen; ++j) {
+            k[j] = key[j];
+        }
+        const auto& input = Lit::get();
+        constexpr std::size_t base = B * BlockLen;
+        constexpr std::size_t len = (N - base < BlockLen) ? N - base : BlockLen;
+        for (std::size_t i = 0; i < len; ++i) {
+            out.v[i] = input[base + i] ^ static_cast<CharT>(k[i % KeyLen]);
+        }
+        return out;
+    }
+
+    template<std::size_t B>
+    static constexpr block_type cipher_block = encrypt_block<B>();
+
+    template<std::size_t... Bs>
+    static constexpr std::array<block_type, Blocks> encrypt(std::index_sequence<Bs...>) noexcept {
+        return {{ cipher_block<Bs>... }};
+    }
+
+    alignas(64) std::array<block_type, Blocks> blocks;
+    mutable std::atomic<uint8_t> state{state_encrypted};
+    uint32_t slot = 0;
+
+    constexpr XorLargeStringBase() : blocks(encrypt(std::make_index_sequence<Blocks>{})) {}
+
+    // Blocks start on cache-line boundaries and carry their own key, so any range of
+    // them can be processed independently (see obf::parallel_decrypt).
+    void xor_blocks(std::size_t first, std::size_t last) noexcept {
+        for (std::size_t b = first; b < last; ++b) {
+            const std::size_t len = (b + 1 == Blocks) ? N - b * BlockLen : BlockLen;
+            xor_key_stream(blocks[b].v, len, make_rolling_key<KeyLen>(block_seed(Seed, b)));
+        }
+    }
+
+    // The whole payload. The blocks are contiguous, but a plain blocks[0].v lets the
+    // compiler size the string at one block and fold strcmp and friends past it.
+    CharT* data() noexcept {
+        CharT* p = blocks[0].v;
+        __asm__("" : "+r"(p));
+        return p;
+    }
+
+    const CharT* data() const noexcept {
+        const CharT* p = blocks[0].v;
+        __asm__("" : "+r"(p));
+        return p;
+    }
+
+    CharT* decrypt() noexcept {
+        decrypt_once(state, [this] {
+            xor_blocks(0, Blocks);
+            track_decrypted(slot, this, &reencrypt_site<XorLargeStringBase>);
+        });
+        return data();
+    }
+
+    const CharT* c_str() const noexcept {
+        return state.load(std::memory_order_acquire) == state_decrypted ? data() : nullptr;
+    }
+
+    // Writes the N plaintext characters into out without decrypting the stored copy.
+    void decrypt_to(CharT* out) const noexcept {
+        decrypt_range_to(out, 0, N);
+    }
+
+    // Plaintext of [first, last) into out + first. first must be a multiple of KeyLen.
+    void decrypt_range_to(CharT* out, std::size_t first, std::size_t last) const noexcept {
+        read_storage(state, [&](bool encrypted) {
+            for (std::size_t b = first / BlockLen; b * BlockLen < last; ++b) {
+                const std::size_t lo = std::max(first, b * BlockLen);
+                const std::size_t hi = std::min(last, (b + 1) * BlockLen);
+                const CharT* src = blocks[b].v + (lo - b * BlockLen);
+                if (encrypted) {
+                    xor_key_stream(out + lo, src, hi - lo, make_rolling_key<KeyLen>(block_seed(Seed, b)));
+                } else {
+                    std::copy(src, src + (hi - lo), out + lo);
+                }
+            }
+        });
+    }
+
+    // Only the head of the payload: a multi-megabyte prefetch would just evict itself.
+    void prefetch() const noexcept {
+        prefetch_range(blocks.data(), std::min(sizeof(blocks), sizeof(block_type)));
+        __builtin_prefetch(&state, 1, 3);
+    }
+
+    // Terminal, as for XorStringStorage: the payload reads back empty afterwards.
+    void zeroize() noexcept {
+        auto* p = reinterpret_cast<char*>(blocks.data());
+        std::fill(blocks.begin(), blocks.end(), block_type{});
+        __builtin___clear_cache(p, p + sizeof(blocks));
+        state.store(state_decrypted, std::memory_order_release);
+        track_wiped(slot);
+    }
+
+    // Back to ciphertext; the next decrypt() starts over. Must not race with readers.
+    void reencrypt() noexcept {
+        if (state.load(std::memory_order_acquire) == state_decrypted) {
+            xor_blocks(0, Blocks);
+            state.store(state_encrypted, std::memory_order_release);
+            track_wiped(slot);
+        }
+    }
+
+    ~XorLargeStringBase() {
+        if (exit_wipe_needed(slot)) {
+            zeroize();
+        }
+    }
+};
+
+template<typename Lit, std::size_t Seed = large_literal_seed<char, Lit>::value>
+struct XorLargeString : XorLargeStringBase<char, Lit, Seed> {};
+
+template<typename Lit, std::size_t Seed = large_literal_seed<wchar_t, Lit>::value>
+struct XorLargeWString : XorLargeStringBase<wchar_t, Lit, Seed> {};
+
+
+// What OBF_CMP / OBF_W_CMP return: converts to string_view by decrypting, but ==, != and
+// <=> against strings go to the fused decrypt-and-compare kernels and leave the static
+// encrypted. The pointer conversion is explicit, or s.starts_with(OBF_CMP("..")) and
+// p == OBF_CMP("..") would have two conversions to pick from; C APIs take .c_str(). OBF
+// and OBF_W keep returning plain pointers.
+template<typename XS>
+class xor_proxy {
+public:
+    using char_type = typename XS::char_type;
+    using view_type = std::basic_string_view<char_type>;
+
+    explicit constexpr xor_proxy(XS& xs) noexcept : xs_(&xs) {}
+
+    explicit operator const char_type*() const noexcept { return xs_->decrypt(); }
+    operator view_type() const noexcept { return { xs_->decrypt(), XS::Length - 1 }; }
+    const char_type* c_str() const noexcept { return xs_->decrypt(); }
+    XS& storage() const noexcept { return *xs_; }
+
+    friend bool operator==(const xor_proxy& p, view_type s) noexcept { return p.xs_->equals(s); }
+    friend bool operator==(view_type s, const xor_proxy& p) noexcept { return p.xs_->equals(s); }
+    friend bool operator!=(const xor_proxy& p, view_type s) noexcept { return !p.xs_->equals(s); }
+    friend bool operator!=(view_type s, const xor_proxy& p) noexcept { return !p.xs_->equals(s); }
+#if defined(__cpp_impl_three_way_comparison) && defined(__cpp_lib_three_way_comparison)
+    friend std::strong_ordering operator<=>(const xor_proxy& p, view_type s) noexcept {
+        return p.xs_->compare(s) <=> 0;
+    }
+#endif
+
+private:
+    XS* xs_;
+};
 
 #define OBF(str) []() -> const char* { \
-    static obff_internal::XorString<sizeof(str)> xs(str); \
-    return xs.decrypt(); \
+    static obff_internal::XorString<sizeof(str), obff_internal::literal_seed(str)> xs(str); \
+    OBF_SITE(xs) \
+    OBF_SITE_DECRYPT(xs, OBF_STR_SITE_ID(str)) \
 }()
 
 #define OBF_SEED(str, seed) []() -> const char* { \
     static obff_internal::XorString<sizeof(str), (seed)> xs(str); \
-    return xs.decrypt(); \
+    OBF_SITE(xs) \
+    OBF_SITE_DECRYPT(xs, OBF_STR_SITE_ID(str)) \
 }()
 
 #define OBF_W(str) []() -> const wchar_t* { \
-    static obff_internal::XorWString<sizeof(str)/sizeof(wchar_t)> xs(str); \
-    return xs.decrypt(); \
+    static obff_internal::XorWString<sizeof(str)/sizeof(wchar_t), obff_internal::literal_seed(str)> xs(str); \
+    OBF_SITE(xs) \
+    OBF_SITE_DECRYPT(xs, OBF_STR_SITE_ID(str)) \
 }()
 
 #define OBF_W_SEED(str, seed) []() -> const wchar_t* { \
     static obff_internal::XorWString<(sizeof(str)/sizeof(wchar_t)), (seed)> xs(str); \
-    return xs.decrypt(); \
+    OBF_SITE(xs) \
+    OBF_SITE_DECRYPT(xs, OBF_STR_SITE_ID(str)) \
+}()
+
+// Comparison forms: the same string behind an xor_proxy, so `header == OBF_CMP("...")`
+// compares against the ciphertext. Conversions decrypt with decrypt(), outside any
+// profile policy; the site still counts as a profile hit.
+#define OBF_CMP(str) []() { \
+    static obff_internal::XorString<sizeof(str), obff_internal::literal_seed(str)> xs(str); \
+    OBF_SITE(xs) \
+    OBF_PROFILE_HIT(OBF_STR_SITE_ID(str)) \
+    return obff_internal::xor_proxy<std::remove_reference_t<decltype(xs)>>(xs); \
+}()
+
+#define OBF_W_CMP(str) []() { \
+    static obff_internal::XorWString<sizeof(str)/sizeof(wchar_t), obff_internal::literal_seed(str)> xs(str); \
+    OBF_SITE(xs) \
+    OBF_PROFILE_HIT(OBF_STR_SITE_ID(str)) \
+    return obff_internal::xor_proxy<std::remove_reference_t<decltype(xs)>>(xs); \
+}()
+
+#define OBF_REF(str) []() -> auto& { \
+    static obff_internal::XorString<sizeof(str), obff_internal::literal_seed(str)> xs(str); \
+    OBF_SITE(xs) \
+    return xs; \
+}()
+
+#define OBF_W_REF(str) []() -> auto& { \
+    static obff_internal::XorWString<sizeof(str)/sizeof(wchar_t), obff_internal::literal_seed(str)> xs(str); \
+    OBF_SITE(xs) \
+    return xs; \
+}()
+
+// Forms emitted by tools/obf_encrypt.cpp in place of OBF / OBF_W / OBF_REF / OBF_W_REF:
+// N, seed and the plaintext hash followed by the N ciphertext characters, bit-identical
+// to what the constexpr path computes. Sources can be run through the tool as a build
+// step to skip the per-literal constant evaluation, or compiled as is.
+#define OBF_CIPHER(n, seed, hash, ...) []() -> const char* { \
+    static obff_internal::XorString<(n), (seed)> xs(obff_internal::preencrypted, (hash), { __VA_ARGS__ }); \
+    OBF_SITE(xs) \
+    OBF_SITE_DECRYPT(xs, OBF_SITE_ID(hash)) \
+}()
+
+#define OBF_W_CIPHER(n, seed, hash, ...) []() -> const wchar_t* { \
+    static obff_internal::XorWString<(n), (seed)> xs(obff_internal::preencrypted, (hash), { __VA_ARGS__ }); \
+    OBF_SITE(xs) \
+    OBF_SITE_DECRYPT(xs, OBF_SITE_ID(hash)) \
+}()
+
+#define OBF_CIPHER_REF(n, seed, hash, ...) []() -> auto& { \
+    static obff_internal::XorString<(n), (seed)> xs(obff_internal::preencrypted, (hash), { __VA_ARGS__ }); \
+    OBF_SITE(xs) \
+    return xs; \
+}()
+
+#define OBF_W_CIPHER_REF(n, seed, hash, ...) []() -> auto& { \
+    static obff_internal::XorWString<(n), (seed)> xs(obff_internal::preencrypted, (hash), { __VA_ARGS__ }); \
+    OBF_SITE(xs) \
+    return xs; \
+}()
+
+#define OBF_PREFETCH(xs) (xs).prefetch()
+
+#if defined(__cpp_constinit)
+#define OBF_CONSTINIT constinit
+#else
+#define OBF_CONSTINIT
+#endif
+
+// Namespace-scope obfuscated constant: ciphertext is emitted as initialized data, with no
+// dynamic initializer and no guard, and `inline` gives one shared object across TUs.
+// Lazy by default (name.decrypt() on use); the _EAGER forms decrypt during static init.
+#define OBF_GLOBAL(name, str) \
+    inline OBF_CONSTINIT obff_internal::XorGlobalString<sizeof(str), \
+        obff_internal::literal_seed(str, obff_internal::literal_seed(#name))> name{str}
+
+#define OBF_W_GLOBAL(name, str) \
+    inline OBF_CONSTINIT obff_internal::XorGlobalWString<sizeof(str)/sizeof(wchar_t), \
+        obff_internal::literal_seed(str, obff_internal::literal_seed(#name))> name{str}
+
+#define OBF_GLOBAL_EAGER(name, str) \
+    OBF_GLOBAL(name, str); \
+    inline const bool name##_obf_eager = (name.decrypt(), true)
+
+#define OBF_W_GLOBAL_EAGER(name, str) \
+    OBF_W_GLOBAL(name, str); \
+    inline const bool name##_obf_eager = (name.decrypt(), true)
+
+#define OBF_LARGE(str) []() -> const char* { \
+    struct obf_lit { static constexpr decltype(auto) get() noexcept { return str; } }; \
+    static obff_internal::XorLargeString<obf_lit> xs; \
+    OBF_SITE(xs) \
+    OBF_SITE_DECRYPT(xs, OBF_SITE_ID((obff_internal::large_literal_seed<char, obf_lit>::value))) \
+}()
+
+#define OBF_LARGE_SEED(str, seed) []() -> const char* { \
+    struct obf_lit { static constexpr decltype(auto) get() noexcept { return str; } }; \
+    static obff_internal::XorLargeString<obf_lit, (seed)> xs; \
+    OBF_SITE(xs) \
+    OBF_SITE_DECRYPT(xs, OBF_SITE_ID((obff_internal::large_literal_seed<char, obf_lit>::value))) \
+}()
+
+#define OBF_W_LARGE(str) []() -> const wchar_t* { \
+    struct obf_lit { static constexpr decltype(auto) get() noexcept { return str; } }; \
+    static obff_internal::XorLargeWString<obf_lit> xs; \
+    OBF_SITE(xs) \
+    OBF_SITE_DECRYPT(xs, OBF_SITE_ID((obff_internal::large_literal_seed<wchar_t, obf_lit>::value))) \
 }()
+
+#define OBF_W_LARGE_SEED(str, seed) []() -> const wchar_t* { \
+    struct obf_lit { static constexpr decltype(auto) get() noexcept { return str; } }; \
+    static obff_internal::XorLargeWString<obf_lit, (seed)> xs; \
+    OBF_SITE(xs) \
+    OBF_SITE_DECRYPT(xs, OBF_SITE_ID((obff_internal::large_literal_seed<wchar_t, obf_lit>::value))) \
+}()
+
+#define OBF_LARGE_REF(str) []() -> auto& { \
+    struct obf_lit { static constexpr decltype(auto) get() noexcept { return str; } }; \
+    static obff_internal::XorLargeString<obf_lit> xs; \
+    OBF_SITE(xs) \
+    return xs; \
+}()
+
+#define OBF_W_LARGE_REF(str) []() -> auto& { \
+    struct obf_lit { static constexpr decltype(auto) get() noexcept { return str; } }; \
+    static obff_internal::XorLargeWString<obf_lit> xs; \
+    OBF_SITE(xs) \
+    return xs; \
+}()
+
+// Integer table kept encrypted at rest: element i is stored as plain[i] ^ key(i) and
+// decoded on every read, so no pass ever leaves the whole table in plaintext. key(i)
+// is one multiply and a shift on the index, computed in registers while the load is in
+// flight, so a lookup costs about what a plain table lookup does. The gather path
+// decodes 8 (4 for 64-bit elements) lookups per AVX2 instruction sequence. There is no
+// default Seed; OBF_TABLE derives one from the table's name and contents (table_seed).
+template<typename T, std::size_t N, std::size_t Seed>
+class XorTable {
+    static_assert(std::is_integral_v<T>, "XorTable holds integers");
+    static_assert(sizeof(T) <= 8, "XorTable elements are at most 64 bits");
+
+    using U = std::make_unsigned_t<T>;
+    static constexpr uint32_t s0 = static_cast<uint32_t>(mix_seed(Seed));
+
+    static constexpr uint32_t key32(uint32_t x) noexcept {
+        const uint32_t z = (x ^ s0) * 0x9e3779b1u;
+        return z ^ (z >> 16);
+    }
+
+    // 64-bit keys are the 32-bit keys of 2i and 2i + 1, which is the lane layout the
+    // 64-bit gather needs.
+    static constexpr U key(std::size_t i) noexcept {
+        if constexpr (sizeof(T) == 8) {
+            const auto x = static_cast<uint32_t>(2 * i);
+            return static_cast<U>(key32(x)) | (static_cast<U>(key32(x + 1)) << 32);
+        } else {
+            return static_cast<U>(key32(static_cast<uint32_t>(i)));
+        }
+    }
+
+public:
+    using value_type = T;
+
+    constexpr XorTable(const T (&plain)[N]) noexcept : cipher_{} {
+        for (std::size_t i = 0; i < N; ++i) {
+            cipher_[i] = static_cast<U>(static_cast<U>(plain[i]) ^ key(i));
+        }
+    }
+
+    // No bounds check, like a plain array. The barrier hides the loaded ciphertext from
+    // the optimizer, which could otherwise fold a constant index of a constant-initialized
+    // table straight to the plaintext value.
+    T operator[](std::size_t i) const noexcept {
+        U c = cipher_[i];
+        __asm__("" : "+r"(c));
+        return static_cast<T>(c ^ key(i));
+    }
+
+    static constexpr std::size_t size() noexcept { return N; }
+
+    // out[k] = (*this)[idx[k]] for k < n.
+    void lookup(const uint32_t* idx, T* out, std::size_t n) const noexcept {
+        std::size_t k = 0;
+#if defined(__AVX2__)
+        if constexpr (sizeof(T) == 8) {
+            for (const std::size_t end = n & ~std::size_t{3}; k < end; k += 4) {
+                const __m128i i = _mm_loadu_si128(reinterpret_cast<const __m128i*>(idx + k));
+                const __m256i v = _mm256_i32gather_epi64(reinterpret_cast<const long long*>(cipher_), i, 8);
+                const __m256i x2 = _mm256_slli_epi64(_mm256_cvtepu32_epi64(i), 1);
+                const __m256i x = _mm256_or_si256(
+                    x2, _mm256_slli_epi64(_mm256_add_epi64(x2, _mm256_set1_epi64x(1)), 32));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + k), _mm256_xor_si256(v, key8(x)));
+            }
+        } else {
+            for (const std::size_t end = n & ~std::size_t{7}; k < end; k += 8) {
+                const __m256i i = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(idx + k));
+                const __m256i v = _mm256_i32gather_epi32(reinterpret_cast<const int*>(cipher_), i, sizeof(T));
+                store8(out + k, _mm256_xor_si256(v, key8(i)));
+            }
+        }
+#endif
+        for (; k < n; ++k) {
+            out[k] = (*this)[idx[k]];
+        }
+    }
+
+private:
+#if defined(__AVX2__)
+    static __m256i key8(__m256i x) noexcept {
+        const __m256i z = _mm256_mullo_epi32(_mm256_xor_si256(x, _mm256_set1_epi32(static_cast<int>(s0))),
+                                             _mm256_set1_epi32(static_cast<int>(0x9e3779b1u)));
+        return _mm256_xor_si256(z, _mm256_srli_epi32(z, 16));
+    }
+
+    // Narrows eight decoded 32-bit lanes to T and stores them.
+    static void store8(T* out, __m256i v) noexcept {
+        if constexpr (sizeof(T) == 4) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), v);
+        } else if constexpr (sizeof(T) == 2) {
+            const __m256i p = _mm256_packus_epi32(_mm256_and_si256(v, _mm256_set1_epi32(0xffff)), v);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out),
+                             _mm256_castsi256_si128(_mm256_permute4x64_epi64(p, 0x08)));
+        } else {
+            const __m256i w = _mm256_packus_epi32(_mm256_and_si256(v, _mm256_set1_epi32(0xff)), v);
+            const __m256i b = _mm256_packus_epi16(w, w);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(out),
+                             _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(b, _mm256_setr_epi32(0, 4, 0, 0, 0, 0, 0, 0))));
+        }
+    }
+#endif
+
+    // Narrow elements are gathered as 32-bit loads; the padding keeps the last one inside.
+    alignas(32) U cipher_[N + 4 / sizeof(U)];
+};
+
+// Seed of an OBF_TABLE: its name and contents, which every TU sees alike, so the inline
+// variable has one definition everywhere.
+template<typename T, std::size_t N>
+constexpr std::size_t table_seed(const T (&values)[N], uint64_t salt) noexcept {
+    uint64_t h = salt ^ N;
+    for (std::size_t i = 0; i < N; ++i) {
+        h = mix_seed(h ^ static_cast<uint64_t>(values[i]));
+    }
+    return static_cast<std::size_t>(h);
+}
+
+#define OBF_TABLE(name, T, N, ...) \
+    inline OBF_CONSTINIT const obff_internal::XorTable<T, N, \
+        obff_internal::table_seed<T, N>({__VA_ARGS__}, obff_internal::literal_seed(#name))> name{{__VA_ARGS__}}
+
+// obf::request_arena doubles as a pmr resource where the library has one.
+#if defined(__cpp_lib_memory_resource)
+using arena_base = std::pmr::memory_resource;
+#else
+struct arena_base {};
+#endif
+}
+
+namespace obf {
+
+// Decrypts straight into the string's own buffer: the static stays encrypted and the
+// only allocation is the string's (none when the text fits in the SSO buffer). Without
+// resize_and_overwrite the buffer is value-initialized first, one extra cheap pass.
+template<typename XS, typename Alloc = std::allocator<typename XS::char_type>>
+std::basic_string<typename XS::char_type, std::char_traits<typename XS::char_type>, Alloc>
+to_string(const XS& xs, const Alloc& alloc = Alloc()) {
+    using CharT = typename XS::char_type;
+    constexpr std::size_t len = XS::Length - 1;
+    std::basic_string<CharT, std::char_traits<CharT>, Alloc> out(alloc);
+#if defined(__cpp_lib_string_resize_and_overwrite)
+    out.resize_and_overwrite(len, [&](CharT* buf, std::size_t) noexcept {
+        xs.decrypt_to(buf);
+        return len;
+    });
+#else
+    out.resize(len);
+    xs.decrypt_to(&out[0]);
+#endif
+    return out;
+}
+
+#if defined(__cpp_lib_memory_resource)
+template<typename XS>
+std::pmr::basic_string<typename XS::char_type>
+to_pmr_string(const XS& xs, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) {
+    return to_string(xs, std::pmr::polymorphic_allocator<typename XS::char_type>(resource));
+}
+#endif
+
+// Incremental decryption into a caller buffer of XS::Length characters, at most `budget`
+// characters per step(), for event loops that cannot afford one long pass. The budget is
+// rounded up to whole key rounds. The static itself is never modified.
+template<typename XS>
+class decrypt_stepper {
+public:
+    using char_type = typename XS::char_type;
+
+    decrypt_stepper(const XS& xs, char_type* out, std::size_t budget) noexcept
+        : xs_(xs), out_(out),
+          budget_(std::max<std::size_t>(1, (budget + XS::KeyLen - 1) / XS::KeyLen) * XS::KeyLen) {}
+
+    // Decrypts the next chunk; returns true once the whole string is in the buffer.
+    bool step() noexcept {
+        const std::size_t last = std::min(XS::Length, pos_ + budget_);
+        xs_.decrypt_range_to(out_, pos_, last);
+        pos_ = last;
+        return done();
+    }
+
+    bool done() const noexcept { return pos_ == XS::Length; }
+    std::size_t position() const noexcept { return pos_; }
+
+private:
+    const XS& xs_;
+    char_type* out_;
+    std::size_t budget_;
+    std::size_t pos_ = 0;
+};
+
+template<typename XS>
+decrypt_stepper<XS> decrypt_steps(const XS& xs, typename XS::char_type* out, std::size_t budget) noexcept {
+    return decrypt_stepper<XS>(xs, out, budget);
+}
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+// co_await-able form of decrypt_stepper. The first chunk runs inline; every later chunk
+// is handed to post(fn), which must run fn on a later tick of the caller's loop, and
+// the coroutine resumes after the last one.
+template<typename XS, typename Post>
+class decrypt_awaitable {
+public:
+    decrypt_awaitable(const XS& xs, typename XS::char_type* out, std::size_t budget, Post post)
+        : stepper_(xs, out, budget), post_(std::move(post)) {}
+
+    bool await_ready() noexcept { return stepper_.step(); }
+
+    void await_suspend(std::coroutine_handle<> h) {
+        post_([this, h] { run(h); });
+    }
+
+    void await_resume() const noexcept {}
+
+private:
+    void run(std::coroutine_handle<> h) {
+        if (stepper_.step()) {
+            h.resume();
+        } else {
+            post_([this, h] { run(h); });
+        }
+    }
+
+    decrypt_stepper<XS> stepper_;
+    Post post_;
+};
+
+template<typename XS, typename Post>
+decrypt_awaitable<XS, std::decay_t<Post>>
+decrypt_async(const XS& xs, typename XS::char_type* out, std::size_t budget, Post&& post) {
+    return decrypt_awaitable<XS, std::decay_t<Post>>(xs, out, budget, std::forward<Post>(post));
+}
+#endif
+
+// Runtime secret held encrypted with the library's key stream, keyed by the process
+// secret and a fresh nonce per ingest(). ingest() encrypts straight out of an I/O buffer
+// and zeroes that buffer in the same SIMD pass: no intermediate plaintext copy and one
+// sweep instead of copy + wipe. The key seed is fixed at ingest, so contents inherited
+// across fork() stay readable after the child re-keys.
+template<std::size_t Capacity>
+class secret {
+public:
+    secret() noexcept = default;
+    secret(const secret&) = delete;
+    secret& operator=(const secret&) = delete;
+    ~secret() { wipe(); }
+
+    // Returns false, leaving both buffers untouched, if n exceeds Capacity.
+    bool ingest(void* src, std::size_t n) noexcept {
+        if (n > Capacity) {
+            return false;
+        }
+        seed_ = obff_internal::mix_seed(obff_internal::process_secret() ^ obff_internal::next_nonce());
+        obff_internal::xor_key_stream_consume(data_.data(), static_cast<uint8_t*>(src), n, key());
+        size_ = n;
+        return true;
+    }
+
+    // Writes the size() plaintext bytes into out.
+    void decrypt_to(void* out) const noexcept {
+        obff_internal::xor_key_stream(static_cast<uint8_t*>(out), data_.data(), size_, key());
+    }
+
+    std::size_t size() const noexcept { return size_; }
+
+    void wipe() noexcept {
+        obff_internal::secure_wipe(data_.data(), data_.size());
+        size_ = 0;
+    }
+
+private:
+    std::array<uint8_t, 32> key() const noexcept {
+        return obff_internal::make_rolling_key<32>(static_cast<std::size_t>(seed_));
+    }
+
+    alignas(32) std::array<uint8_t, Capacity> data_{};
+    std::size_t size_ = 0;
+    uint64_t seed_ = 0;
+};
+
+// Bump arena for plaintext that lives as long as one request. Each decrypt() copies a
+// string's plaintext into the next 32-byte-aligned slot (the static stays encrypted);
+// reset() or the destructor wipes everything handed out in one pass and rewinds. No heap
+// traffic, and the arena can sit on the stack or in a thread_local reused per request.
+//
+//     obf::request_arena<4096> arena;
+//     const char* user = arena.decrypt(OBF_REF("svc-user"));
+//     auto header = obf::to_pmr_string(OBF_REF("X-Api-Key"), &arena);
+//     ...
+//     arena.reset();                                  // end of request
+//
+// decrypt() returns nullptr when the arena is full. As a pmr resource it throws
+// std::bad_alloc instead, and deallocation is a no-op until reset(). Short pmr strings
+// keep their text in the string object (SSO), outside the arena.
+template<std::size_t Capacity>
+class request_arena : public obff_internal::arena_base {
+public:
+    request_arena() noexcept = default;
+    request_arena(const request_arena&) = delete;
+    request_arena& operator=(const request_arena&) = delete;
+    ~request_arena() { reset(); }
+
+    template<typename XS>
+    const typename XS::char_type* decrypt(const XS& xs) noexcept {
+        typename XS::char_type* out = buffer_for(xs);
+        if (out != nullptr) {
+            xs.decrypt_to(out);
+        }
+        return out;
+    }
+
+    // Empty view when the arena is full.
+    template<typename XS>
+    std::basic_string_view<typename XS::char_type> view(const XS& xs) noexcept {
+        const auto* p = decrypt(xs);
+        return p != nullptr ? std::basic_string_view<typename XS::char_type>(p, XS::Length - 1)
+                            : std::basic_string_view<typename XS::char_type>();
+    }
+
+    template<std::size_t C>
+    const uint8_t* decrypt(const secret<C>& s) noexcept {
+        auto* out = static_cast<uint8_t*>(allocate_bytes(s.size()));
+        if (out != nullptr) {
+            s.decrypt_to(out);
+        }
+        return out;
+    }
+
+    // Uninitialized room for XS::Length characters, e.g. the target of decrypt_steps.
+    template<typename XS>
+    typename XS::char_type* buffer_for(const XS&) noexcept {
+        return static_cast<typename XS::char_type*>(allocate_bytes(sizeof(typename XS::char_type) * XS::Length));
+    }
+
+    void* allocate_bytes(std::size_t n, std::size_t align = 32) noexcept {
+        const auto base = reinterpret_cast<std::uintptr_t>(buffer_);
+        const std::size_t start = ((base + used_ + align - 1) & ~(align - 1)) - base;
+        if (start > Capacity || n > Capacity - start) {
+            return nullptr;
+        }
+        used_ = start + n;
+        return buffer_ + start;
+    }
+
+    void reset() noexcept {
+        obff_internal::secure_wipe(buffer_, used_);
+        used_ = 0;
+    }
+
+    std::size_t used() const noexcept { return used_; }
+    std::size_t remaining() const noexcept { return Capacity - used_; }
+    static constexpr std::size_t capacity() noexcept { return Capacity; }
+
+private:
+#if defined(__cpp_lib_memory_resource)
+    void* do_allocate(std::size_t n, std::size_t align) override {
+        void* p = allocate_bytes(n, std::max<std::size_t>(align, 32));
+        if (p == nullptr) {
+            throw std::bad_alloc();
+        }
+        return p;
+    }
+
+    void do_deallocate(void*, std::size_t, std::size_t) override {}
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+#endif
+
+    alignas(64) unsigned char buffer_[Capacity];
+    std::size_t used_ = 0;
+};
+
+// Decrypts a group of strings into one contiguous scratch block that lives on the stack,
+// exposes each by index and wipes the block with a single pass on scope exit. The
+// statics stay encrypted. Strings start on 32-byte boundaries so each runs whole SIMD
+// key rounds.
+//
+//     obf::window w{OBF_REF("user"), OBF_REF("pass"), OBF_REF("host")};
+//     login(w.get<0>(), w.get<1>(), w.get<2>());
+template<typename... XS>
+class window {
+    static constexpr std::size_t count = sizeof...(XS);
+    static_assert(count > 0, "obf::window needs at least one string");
+
+    static constexpr std::array<std::size_t, count + 1> layout() noexcept {
+        std::array<std::size_t, count + 1> offsets{};
+        const std::size_t bytes[] = { sizeof(typename XS::char_type) * XS::Length... };
+        for (std::size_t i = 0; i < count; ++i) {
+            offsets[i + 1] = (offsets[i] + bytes[i] + 31) & ~std::size_t{31};
+        }
+        return offsets;
+    }
+
+    static constexpr auto offsets = layout();
+
+    template<std::size_t I>
+    using xs_at = std::tuple_element_t<I, std::tuple<XS...>>;
+
+public:
+    explicit window(const XS&... xs) noexcept {
+        std::size_t i = 0;
+        (xs.decrypt_to(reinterpret_cast<typename XS::char_type*>(scratch_ + offsets[i++])), ...);
+    }
+
+    window(const window&) = delete;
+    window& operator=(const window&) = delete;
+
+    ~window() { obff_internal::secure_wipe(scratch_, sizeof(scratch_)); }
+
+    template<std::size_t I>
+    const typename xs_at<I>::char_type* get() const noexcept {
+        return reinterpret_cast<const typename xs_at<I>::char_type*>(scratch_ + offsets[I]);
+    }
+
+    template<std::size_t I>
+    std::basic_string_view<typename xs_at<I>::char_type> view() const noexcept {
+        return { get<I>(), xs_at<I>::Length - 1 };
+    }
+
+private:
+    alignas(64) unsigned char scratch_[offsets[count]];
+};
+
+template<typename... XS>
+window(const XS&...) -> window<XS...>;
+
+// Argument or environment vector for execve / posix_spawn, built from obfuscated strings
+// in one stack block: the null-terminated pointer array comes first, the strings follow
+// on 32-byte boundaries as in window. Wiped on scope exit; a successful execve replaces
+// the image, so nothing outlives the call either way.
+//
+// The pointers point into the object itself, so it can be neither copied nor moved, and
+// they are valid only until wipe() or scope exit. wipe() zeroes the pointer array too,
+// after which the vector reads as empty. posix_spawn and execve copy the vector into the
+// new process before they return, so it may be wiped right after the call.
+//
+//     obf::argv args{OBF_REF("/usr/bin/helper"), OBF_REF("--token-file"), OBF_REF("/run/t")};
+//     obf::envp env{OBF_REF("HELPER_MODE=strict")};
+//     execve(args[0], args, env);
+template<typename... XS>
+class exec_vector {
+    static constexpr std::size_t count = sizeof...(XS);
+    static_assert((std::is_same_v<typename XS::char_type, char> && ...), "exec vectors hold narrow strings");
+
+    static constexpr std::array<std::size_t, count + 1> layout() noexcept {
+        std::array<std::size_t, count + 1> offsets{};
+        const std::size_t bytes[] = { XS::Length..., 0 };
+        offsets[0] = (sizeof(char*) * (count + 1) + 31) & ~std::size_t{31};
+        for (std::size_t i = 0; i < count; ++i) {
+            offsets[i + 1] = (offsets[i] + bytes[i] + 31) & ~std::size_t{31};
+        }
+        return offsets;
+    }
+
+    static constexpr auto offsets = layout();
+
+public:
+    explicit exec_vector(const XS&... xs) noexcept {
+        char** ptrs = pointers();
+        std::size_t i = 0;
+        ((ptrs[i] = reinterpret_cast<char*>(scratch_ + offsets[i]), xs.decrypt_to(ptrs[i]), ++i), ...);
+        ptrs[count] = nullptr;
+    }
+
+    exec_vector(const exec_vector&) = delete;
+    exec_vector& operator=(const exec_vector&) = delete;
+
+    ~exec_vector() { wipe(); }
+
+    char* const* data() const noexcept { return const_cast<exec_vector*>(this)->pointers(); }
+    operator char* const*() const noexcept { return data(); }
+    const char* operator[](std::size_t i) const noexcept { return data()[i]; }
+    static constexpr std::size_t size() noexcept { return count; }
+
+    void wipe() noexcept { obff_internal::secure_wipe(scratch_, sizeof(scratch_)); }
+
+private:
+    char** pointers() noexcept { return reinterpret_cast<char**>(scratch_); }
+
+    alignas(64) unsigned char scratch_[offsets[count]];
+};
+
+template<typename... XS>
+class argv : public exec_vector<XS...> {
+public:
+    using exec_vector<XS...>::exec_vector;
+};
+
+template<typename... XS>
+class envp : public exec_vector<XS...> {
+public:
+    using exec_vector<XS...>::exec_vector;
+};
+
+template<typename... XS>
+argv(const XS&...) -> argv<XS...>;
+
+template<typename... XS>
+envp(const XS&...) -> envp<XS...>;
+
+// Calls fn(object) for every string that is currently decrypted, in O(popcount) over the
+// state bitset. object points at the string's storage.
+template<typename F>
+void for_each_decrypted(F&& fn) {
+    auto& t = obff_internal::tracker;
+    for (std::size_t shard = 0; shard < t.shard_count; ++shard) {
+        for (std::size_t w = 0; w < 8; ++w) {
+            for (uint64_t bits = t.shards[shard].words[w].load(std::memory_order_acquire); bits != 0;
+                 bits &= bits - 1) {
+                const unsigned bit = static_cast<unsigned>(__builtin_ctzll(bits));
+                fn(t.site(t.slot_of(shard, w, bit)).object);
+            }
+        }
+    }
+}
+
+// Number of strings currently resident as plaintext.
+inline std::size_t resident_plaintext() noexcept {
+    std::size_t n = 0;
+    for (const auto& shard : obff_internal::tracker.shards) {
+        for (const auto& word : shard.words) {
+            n += static_cast<std::size_t>(__builtin_popcountll(word.load(std::memory_order_relaxed)));
+        }
+    }
+    return n;
+}
+
+// Re-encrypts exactly the strings that are decrypted and returns how many there were; they
+// decrypt again on their next use. Only atomics and plain stores, so it is safe to call
+// from a signal or panic handler, but like reencrypt() it must not race with readers.
+inline std::size_t wipe_decrypted() noexcept {
+    auto& t = obff_internal::tracker;
+    std::size_t n = 0;
+    for (std::size_t shard = 0; shard < t.shard_count; ++shard) {
+        for (std::size_t w = 0; w < 8; ++w) {
+            for (uint64_t bits = t.shards[shard].words[w].load(std::memory_order_acquire); bits != 0;
+                 bits &= bits - 1) {
+                const auto& site = t.site(t.slot_of(shard, w, static_cast<unsigned>(__builtin_ctzll(bits))));
+                site.reencrypt(site.object);
+                ++n;
+            }
+        }
+    }
+    return n;
+}
+
+// Transparent hash / equality for unordered containers keyed by strings, so obfuscated
+// keys can be looked up directly (C++20 heterogeneous find):
+//
+//     std::unordered_map<std::string, int, obf::hash, obf::equal_to> m;
+//     m.find(OBF_REF("Authorization"));
+//
+// The key's hash is the constant computed from the plaintext at compile time, and
+// equality is a fused decrypt-and-compare: no runtime hashing of the key and no plaintext.
+struct hash {
+    using is_transparent = void;
+
+    template<typename CharT, typename Traits>
+    std::size_t operator()(std::basic_string_view<CharT, Traits> s) const noexcept {
+        return static_cast<std::size_t>(obff_internal::fnv1a(s.data(), s.size()));
+    }
+
+    template<typename CharT, typename Traits, typename Alloc>
+    std::size_t operator()(const std::basic_string<CharT, Traits, Alloc>& s) const noexcept {
+        return static_cast<std::size_t>(obff_internal::fnv1a(s.data(), s.size()));
+    }
+
+    template<typename CharT, std::size_t N, std::size_t Seed>
+    std::size_t operator()(const obff_internal::XorStringStorage<CharT, N, Seed>& xs) const noexcept {
+        return static_cast<std::size_t>(xs.hash);
+    }
+};
+
+struct equal_to {
+    using is_transparent = void;
+
+    template<typename A, typename B,
+             std::enable_if_t<!obff_internal::is_xor_string_v<A> && !obff_internal::is_xor_string_v<B>, int> = 0>
+    bool operator()(const A& a, const B& b) const noexcept {
+        return a == b;
+    }
+
+    template<typename S, typename CharT, std::size_t N, std::size_t Seed>
+    bool operator()(const S& s, const obff_internal::XorStringStorage<CharT, N, Seed>& xs) const noexcept {
+        return xs.equals(std::basic_string_view<CharT>(s));
+    }
+
+    template<typename S, typename CharT, std::size_t N, std::size_t Seed>
+    bool operator()(const obff_internal::XorStringStorage<CharT, N, Seed>& xs, const S& s) const noexcept {
+        return xs.equals(std::basic_string_view<CharT>(s));
+    }
+};
+
+
+#if defined(__unix__) || defined(__APPLE__)
+// getenv for an obfuscated variable name, which is never decrypted. Like glibc, entries
+// are prefiltered on their first two bytes; the second is only read once the first has
+// matched the (non-NUL) first byte of the name, since an entry may be just "". Survivors
+// are compared against ciphertext ^ key in registers by env_entry_matches.
+template<std::size_t N, std::size_t Seed>
+const char* getenv(const obff_internal::XorStringStorage<char, N, Seed>& xs) noexcept {
+    static_assert(N > 1, "obf::getenv needs a non-empty name");
+    using XS = obff_internal::XorStringStorage<char, N, Seed>;
+    constexpr std::size_t len = N - 1;
+    static constexpr uint8_t plain[XS::KeyLen] = {};
+    const char* value = nullptr;
+    obff_internal::read_storage(xs.state, [&](bool encrypted) {
+        const uint8_t* key = encrypted ? XS::key_stream.data() : plain;
+        const char* cipher = xs.data.data();
+        const char head0 = static_cast<char>(cipher[0] ^ key[0]);
+        const char head1 = len > 1 ? static_cast<char>(cipher[1] ^ key[1]) : '=';
+        value = nullptr;
+        if (head0 == '\0') {
+            return;
+        }
+        for (char** env = ::environ; env != nullptr && *env != nullptr; ++env) {
+            const char* e = *env;
+            if (e[0] != head0 || e[1] != head1) {
+                continue;
+            }
+            if (obff_internal::env_entry_matches(e, cipher, key, len)) {
+                value = e + len + 1;
+                return;
+            }
+        }
+    });
+    return value;
+}
+#endif
+
+
+// s.starts_with(OBF_CMP("...")) decrypts the prefix through the string_view conversion;
+// this form compares it against the ciphertext instead.
+template<typename XS>
+bool starts_with(std::basic_string_view<typename XS::char_type> s, const obff_internal::xor_proxy<XS>& prefix) noexcept {
+    return s.size() >= XS::Length - 1 && prefix.storage().equals(s.substr(0, XS::Length - 1));
+}
+
+// Plain overloads, so call sites read the same with OBF and OBF_CMP.
+inline bool starts_with(std::string_view s, std::string_view prefix) noexcept {
+    return s.substr(0, prefix.size()) == prefix;
+}
+
+inline bool starts_with(std::wstring_view s, std::wstring_view prefix) noexcept {
+    return s.substr(0, prefix.size()) == prefix;
+}
+
+
+template<typename T, std::size_t N, std::size_t Seed>
+using table = obff_internal::XorTable<T, N, Seed>;
+
 }
@@ -0,0 +1,107 @@
+#pragma once
+#include "obfuscator.h"
+#if !defined(__unix__) && !defined(__APPLE__)
+#error "obfuscator_fork.h relies on POSIX pthread_atfork"
+#endif
+#include <pthread.h>
+#include <unistd.h>
+
+namespace obff_internal {
+
+// Tracker bits at the moment of the last fork(), read by exit_wipe_needed in the child.
+// Untouched (zero pages, no memory) in processes that never fork.
+inline uint64_t fork_snapshot[state_tracker::shard_count * 8];
+inline std::atomic<uint8_t> fork_mode{0};
+
+// Only changed words are stored, so a child of a process with few decrypted strings
+// barely touches the snapshot's pages.
+inline void snapshot_tracker() noexcept {
+    for (std::size_t shard = 0; shard < state_tracker::shard_count; ++shard) {
+        for (std::size_t w = 0; w < 8; ++w) {
+            const uint64_t bits = tracker.shards[shard].words[w].load(std::memory_order_relaxed);
+            if (fork_snapshot[shard * 8 + w] != bits) {
+                fork_snapshot[shard * 8 + w] = bits;
+            }
+        }
+    }
+}
+
+// Every string the parent had decrypted goes back to ciphertext, in one sweep over the
+// bitset. The child is single-threaded here, so nothing can be reading them.
+inline void reencrypt_inherited() noexcept {
+    for (std::size_t shard = 0; shard < state_tracker::shard_count; ++shard) {
+        for (std::size_t w = 0; w < 8; ++w) {
+            for (uint64_t bits = tracker.shards[shard].words[w].load(std::memory_order_relaxed); bits != 0;
+                 bits &= bits - 1) {
+                const auto& site =
+                    tracker.site(state_tracker::slot_of(shard, w, static_cast<unsigned>(__builtin_ctzll(bits))));
+                site.reencrypt(site.object);
+            }
+        }
+    }
+}
+
+inline void rekey_process() noexcept {
+    const auto now = std::chrono::steady_clock::now().time_since_epoch().count();
+    uint64_t fresh = mix_seed(process_secret() ^ static_cast<uint64_t>(getpid()));
+    fresh = mix_seed(fresh ^ static_cast<uint64_t>(now));
+    forked_secret.store(fresh | 1, std::memory_order_relaxed);
+}
+
+inline void on_fork_child() noexcept;
+
+}
+
+namespace obf {
+
+// What a child does, right after fork() returns in it, with the strings it inherited
+// decrypted from its parent. Plaintext from before the fork sits in pages the two
+// processes still share; any write to them in the child, including the wipes string
+// destructors run at exit, copies them one page at a time.
+//
+//   share  - leave them alone. The child reads the parent's pages and never writes them:
+//            exit-time wipes skip both ciphertext and inherited plaintext, and only
+//            strings the child decrypts itself are wiped. No copy-on-write faults.
+//   wipe   - re-encrypt all of them in one pass before the child runs any code (so
+//            before an exec, and before anything could dump it). One fault per page
+//            holding inherited plaintext, all taken up front; the strings decrypt again
+//            on their next use.
+//   rekey  - share, plus a fresh process secret, so secrets, sinks and channels created
+//            after the fork never reuse the parent's or a sibling's nonces and keys.
+//            Existing obf::secret contents keep their key until their next ingest().
+//
+// A string whose decrypt(), or comparison against its ciphertext, is running on another
+// thread at the moment of fork() stays locked in the child forever; fork from a quiet
+// point, as with any lock.
+enum class fork_policy : uint8_t { inherit, share, wipe, rekey };
+
+// Applies `policy` in children forked after the call; inherit restores the default.
+// The pthread_atfork handler is installed once, on the first call.
+inline void set_fork_policy(fork_policy policy) noexcept {
+    static const int installed = pthread_atfork(nullptr, nullptr, &obff_internal::on_fork_child);
+    (void)installed;
+    obff_internal::fork_mode.store(static_cast<uint8_t>(policy), std::memory_order_relaxed);
+}
+
+inline fork_policy current_fork_policy() noexcept {
+    return static_cast<fork_policy>(obff_internal::fork_mode.load(std::memory_order_relaxed));
+}
+
+}
+
+inline void obff_internal::on_fork_child() noexcept {
+    switch (obf::current_fork_policy()) {
+    case obf::fork_policy::inherit:
+        return;
+    case obf::fork_policy::share:
+        break;
+    case obf::fork_policy::wipe:
+        reencrypt_inherited();
+        break;
+    case obf::fork_policy::rekey:
+        rekey_process();
+        break;
+    }
+    snapshot_tracker();
+    fork_inherited = fork_snapshot;
+}
@@ -0,0 +1,100 @@
+#pragma once
+#include "obfuscator.h"
+#if !defined(__linux__)
+#error "obfuscator_hugepage.h relies on Linux transparent huge pages and mremap"
+#endif
+#include <cstring>
+#include <link.h>
+#include <sys/mman.h>
+
+namespace obff_internal {
+
+constexpr std::uintptr_t huge_page_size = std::uintptr_t{2} << 20;
+
+// The writable PT_LOAD segment of the main program, where every constant-initialized
+// OBF* static lives, plus its RELRO range so it can be re-protected after the move.
+struct data_segment {
+    std::uintptr_t begin = 0;
+    std::uintptr_t end = 0;
+    std::uintptr_t relro_begin = 0;
+    std::uintptr_t relro_end = 0;
+};
+
+inline int find_data_segment(dl_phdr_info* info, std::size_t, void* out) noexcept {
+    auto* seg = static_cast<data_segment*>(out);
+    for (std::size_t i = 0; i < info->dlpi_phnum; ++i) {
+        const auto& ph = info->dlpi_phdr[i];
+        const std::uintptr_t begin = info->dlpi_addr + ph.p_vaddr;
+        if (ph.p_type == PT_LOAD && (ph.p_flags & PF_W) && seg->begin == 0) {
+            seg->begin = begin;
+            seg->end = begin + ph.p_memsz;
+        } else if (ph.p_type == PT_GNU_RELRO) {
+            seg->relro_begin = begin;
+            seg->relro_end = begin + ph.p_memsz;
+        }
+    }
+    return 1;  // the first entry is the main program
+}
+
+// Moves the 2 MiB-aligned interior of [begin, end) onto THP-backed anonymous memory.
+// The copy is built in an aligned scratch mapping and swapped in with one mremap, so
+// the range never reads back as zero. Returns the number of bytes moved.
+inline std::size_t remap_huge(std::uintptr_t begin, std::uintptr_t end) noexcept {
+    const std::uintptr_t lo = (begin + huge_page_size - 1) & ~(huge_page_size - 1);
+    const std::uintptr_t hi = end & ~(huge_page_size - 1);
+    if (hi <= lo) {
+        return 0;
+    }
+    const std::size_t len = hi - lo;
+    void* raw = mmap(nullptr, len + huge_page_size, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) {
+        return 0;
+    }
+    const auto raw_begin = reinterpret_cast<std::uintptr_t>(raw);
+    const std::uintptr_t scratch = (raw_begin + huge_page_size - 1) & ~(huge_page_size - 1);
+    if (scratch != raw_begin) {
+        munmap(raw, scratch - raw_begin);
+    }
+    if (raw_begin + huge_page_size != scratch) {
+        munmap(reinterpret_cast<void*>(scratch + len), raw_begin + huge_page_size - scratch);
+    }
+    madvise(reinterpret_cast<void*>(scratch), len, MADV_HUGEPAGE);
+    std::memcpy(reinterpret_cast<void*>(scratch), reinterpret_cast<const void*>(lo), len);
+    if (mremap(reinterpret_cast<void*>(scratch), len, len, MREMAP_MAYMOVE | MREMAP_FIXED,
+               reinterpret_cast<void*>(lo)) == MAP_FAILED) {
+        munmap(reinterpret_cast<void*>(scratch), len);
+        return 0;
+    }
+    return len;
+}
+
+}
+
+namespace obf {
+
+// Re-backs the program's data segment, and with it every OBF* static, with transparent
+// huge pages, so hot string accesses stop paying 4 KiB page walks. Only whole 2 MiB
+// pages inside the segment can move; link with
+//     -Wl,-z,max-page-size=0x200000 -Wl,-z,common-page-size=0x200000
+// to align the segment itself. Call once at startup, before any other thread exists.
+// Returns the number of bytes now eligible for huge pages.
+inline std::size_t remap_data_hugepages() noexcept {
+    obff_internal::data_segment seg;
+    dl_iterate_phdr(&obff_internal::find_data_segment, &seg);
+    if (seg.begin == 0) {
+        return 0;
+    }
+    const std::size_t moved = obff_internal::remap_huge(seg.begin, seg.end);
+    // The fresh mapping is writable; put RELRO back to read-only where it overlapped.
+    const std::uintptr_t lo = (seg.begin + obff_internal::huge_page_size - 1) & ~(obff_internal::huge_page_size - 1);
+    const std::uintptr_t hi = lo + moved;
+    const std::uintptr_t ro_begin = std::max(seg.relro_begin, lo);
+    const std::uintptr_t ro_end = std::min(seg.relro_end & ~std::uintptr_t{4095}, hi);
+    if (moved != 0 && ro_begin < ro_end) {
+        mprotect(reinterpret_cast<void*>(ro_begin), ro_end - ro_begin, PROT_READ);
+    }
+    return moved;
+}
+
+}
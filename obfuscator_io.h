@@ -0,0 +1,449 @@
+#pragma once
+#include "obfuscator.h"
+#if !defined(__unix__) && !defined(__APPLE__)
+#error "obfuscator_io.h relies on POSIX file descriptors"
+#endif
+#include <cerrno>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace obff_internal {
+
+// File layout: one header block, then the ciphertext. Everything is in units of
+// io_block so O_DIRECT offsets, lengths and buffer addresses stay aligned.
+constexpr std::size_t io_block = 4096;
+
+struct stream_header {
+    static constexpr uint64_t magic_value = 0x4f4246535452454dull;
+
+    uint64_t magic;
+    uint64_t chunk;
+    uint64_t nonce;
+};
+
+// Every io_block-sized chunk of the stream gets its own key; a copy that starts inside a
+// chunk starts at the matching phase of the 32-byte key.
+class chunk_keys {
+public:
+    explicit chunk_keys(uint64_t file_key = 0) noexcept : file_key_(file_key) {}
+
+    // Encrypts or decrypts n bytes at stream offset pos, copying from in to out.
+    void apply(uint8_t* out, const uint8_t* in, std::size_t n, uint64_t pos) noexcept {
+        while (n > 0) {
+            const uint64_t chunk = pos / io_block;
+            const std::size_t piece = std::min<std::size_t>(n, io_block - pos % io_block);
+            if (chunk != chunk_) {
+                chunk_ = chunk;
+                base_ = key_ = stream_key(file_key_, chunk);
+                phase_ = 0;
+            }
+            const std::size_t phase = pos % 32;
+            if (phase != phase_) {
+                std::rotate_copy(base_.begin(), base_.begin() + phase, base_.end(), key_.begin());
+                phase_ = phase;
+            }
+            xor_key_stream(out, in, piece, key_);
+            out += piece;
+            in += piece;
+            pos += piece;
+            n -= piece;
+        }
+    }
+
+private:
+    uint64_t file_key_;
+    uint64_t chunk_ = ~uint64_t{0};
+    std::size_t phase_ = 0;
+    std::array<uint8_t, 32> base_{};
+    std::array<uint8_t, 32> key_{};
+};
+
+inline uint8_t* io_alloc(std::size_t n) noexcept {
+    void* p = nullptr;
+    return posix_memalign(&p, io_block, n) == 0 ? static_cast<uint8_t*>(p) : nullptr;
+}
+
+// pwrite of the whole range. A filesystem that accepted O_DIRECT at open but refuses the
+// write gets the flag dropped and the write retried through the page cache.
+inline int io_write_all(int fd, const uint8_t* data, std::size_t n, uint64_t offset) noexcept {
+    while (n > 0) {
+        const ssize_t w = pwrite(fd, data, n, static_cast<off_t>(offset));
+        if (w < 0) {
+            const int e = errno;
+            if (e == EINTR) {
+                continue;
+            }
+#if defined(O_DIRECT)
+            const int flags = fcntl(fd, F_GETFL);
+            if (e == EINVAL && flags >= 0 && (flags & O_DIRECT) != 0 &&
+                fcntl(fd, F_SETFL, flags & ~O_DIRECT) == 0) {
+                continue;
+            }
+#endif
+            return e;
+        }
+        data += w;
+        n -= static_cast<std::size_t>(w);
+        offset += static_cast<uint64_t>(w);
+    }
+    return 0;
+}
+
+}
+
+namespace obf {
+
+// Output sink that encrypts while it buffers: write() runs the library's SIMD key-stream
+// kernel from the caller's data straight into an aligned buffer, so encrypting costs the
+// same single pass as the memcpy a plain buffered writer does, and neither the buffer nor
+// the file ever hold plaintext. Full buffers go to a background thread that writes them
+// with pwrite (O_DIRECT where the filesystem supports it) while the caller fills the
+// other one. Read the file back with obf::encrypted_source and the same secret.
+//
+//     auto out = obf::encrypted_sink::open("dump.bin", secret);
+//     out.write(record, size);
+//     out.write(line);                // string_view
+//     if (!out.close()) { /* out.error() holds errno */ }
+//
+// Never throws. A failed open yields a sink whose valid() is false and whose error() holds
+// the errno, ENOMEM or EAGAIN when memory or the flusher thread could not be had; after an
+// I/O error write() and close() return false and error() holds the errno.
+class encrypted_sink {
+public:
+    static constexpr std::size_t default_buffer = std::size_t{1} << 20;
+
+    // buffer is rounded up to a multiple of 4 KiB; two of them are allocated.
+    static encrypted_sink open(const char* path, uint64_t secret, std::size_t buffer = default_buffer,
+                               bool direct = true) noexcept {
+        using obff_internal::io_block;
+        encrypted_sink sink;
+        const int flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+        int fd = -1;
+#if defined(O_DIRECT)
+        if (direct) {
+            fd = ::open(path, flags | O_DIRECT, 0600);
+        }
+#else
+        (void)direct;
+#endif
+        if (fd < 0) {
+            fd = ::open(path, flags, 0600);
+        }
+        if (fd < 0) {
+            sink.error_ = errno;
+            return sink;
+        }
+        buffer = std::max(io_block, (buffer + io_block - 1) & ~(io_block - 1));
+        auto* header = obff_internal::io_alloc(io_block);
+        auto* memory = obff_internal::io_alloc(2 * buffer);
+        if (header == nullptr || memory == nullptr) {
+            std::free(header);
+            std::free(memory);
+            ::close(fd);
+            sink.error_ = ENOMEM;
+            return sink;
+        }
+        const uint64_t nonce = obff_internal::mix_seed(obff_internal::process_secret() ^
+                                                       obff_internal::next_nonce());
+        std::memset(header, 0, io_block);
+        const obff_internal::stream_header h{ obff_internal::stream_header::magic_value, io_block, nonce };
+        std::memcpy(header, &h, sizeof(h));
+        const int err = obff_internal::io_write_all(fd, header, io_block, 0);
+        std::free(header);
+        if (err != 0) {
+            std::free(memory);
+            ::close(fd);
+            sink.error_ = err;
+            return sink;
+        }
+        std::unique_ptr<state> s(new (std::nothrow) state(fd, memory, buffer,
+                                                          obff_internal::mix_seed(secret ^ nonce)));
+        if (!s) {
+            std::free(memory);
+            ::close(fd);
+            sink.error_ = ENOMEM;
+            return sink;
+        }
+        // A state without its flusher still owns fd and memory, and releases them here.
+        if (!s->start()) {
+            sink.error_ = EAGAIN;
+            return sink;
+        }
+        sink.state_ = std::move(s);
+        return sink;
+    }
+
+    encrypted_sink() noexcept = default;
+    encrypted_sink(encrypted_sink&&) noexcept = default;
+    encrypted_sink& operator=(encrypted_sink&& other) noexcept {
+        close();
+        state_ = std::move(other.state_);
+        error_ = other.error_;
+        return *this;
+    }
+    ~encrypted_sink() { close(); }
+
+    bool valid() const noexcept { return state_ != nullptr; }
+    int error() const noexcept { return state_ ? state_->error() : error_; }
+
+    // Bytes accepted so far (the plaintext length of the stream).
+    uint64_t size() const noexcept { return state_ ? state_->written : 0; }
+
+    bool write(const void* data, std::size_t n) noexcept {
+        if (!state_) {
+            return false;
+        }
+        state& s = *state_;
+        const auto* src = static_cast<const uint8_t*>(data);
+        while (n > 0) {
+            const std::size_t piece = std::min(n, s.capacity - s.fill);
+            s.keys.apply(s.buffers[s.active] + s.fill, src, piece, s.written);
+            s.fill += piece;
+            s.written += piece;
+            src += piece;
+            n -= piece;
+            if (s.fill == s.capacity && !s.submit()) {
+                return false;
+            }
+        }
+        return s.error() == 0;
+    }
+
+    bool write(std::string_view text) noexcept { return write(text.data(), text.size()); }
+
+    // Writes everything buffered so far and waits for it, without giving up O_DIRECT:
+    // the partial block is padded on disk and rewritten in full by the next flush.
+    bool flush() noexcept {
+        if (!state_) {
+            return false;
+        }
+        state_->drain();
+        return state_->write_partial();
+    }
+
+    // Flushes, trims the padding and closes the file. Idempotent.
+    bool close() noexcept {
+        if (!state_) {
+            return error_ == 0;
+        }
+        bool ok = flush();
+        state_->stop();
+        if (ftruncate(state_->fd, static_cast<off_t>(obff_internal::io_block + state_->written)) != 0 && ok) {
+            state_->fail(errno);
+            ok = false;
+        }
+        error_ = state_->error();
+        state_.reset();
+        return ok;
+    }
+
+private:
+    // Two buffers: the caller fills `active` while the flusher writes the other.
+    struct state {
+        state(int fd_, uint8_t* memory_, std::size_t capacity_, uint64_t key) noexcept
+            : fd(fd_), memory(memory_), capacity(capacity_), keys(key) {
+            buffers[0] = memory;
+            buffers[1] = memory + capacity;
+        }
+
+        // Starts the flusher; false, with no thread to join, if the system refuses one.
+        bool start() noexcept {
+            try {
+                flusher = std::thread([this] { run(); });
+            } catch (...) {
+                return false;
+            }
+            return true;
+        }
+
+        ~state() {
+            ::close(fd);
+            std::free(memory);
+        }
+
+        int error() const noexcept { return err.load(std::memory_order_acquire); }
+
+        void fail(int e) noexcept {
+            int expected = 0;
+            err.compare_exchange_strong(expected, e, std::memory_order_release);
+        }
+
+        // Hands the full active buffer to the flusher and waits for the other one.
+        bool submit() noexcept {
+            const uint64_t offset = obff_internal::io_block + written - fill;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                pending[active] = true;
+                pending_offset[active] = offset;
+                ready.notify_one();
+                active ^= 1;
+                done.wait(lock, [this] { return !pending[active]; });
+            }
+            fill = 0;
+            return error() == 0;
+        }
+
+        void drain() noexcept {
+            std::unique_lock<std::mutex> lock(mutex);
+            done.wait(lock, [this] { return !pending[0] && !pending[1]; });
+        }
+
+        // Writes the active buffer's bytes, padded to whole blocks, from the caller.
+        bool write_partial() noexcept {
+            if (fill == 0) {
+                return error() == 0;
+            }
+            const std::size_t padded = (fill + obff_internal::io_block - 1) & ~(obff_internal::io_block - 1);
+            std::memset(buffers[active] + fill, 0, padded - fill);
+            const int e = obff_internal::io_write_all(fd, buffers[active], padded,
+                                                      obff_internal::io_block + written - fill);
+            if (e != 0) {
+                fail(e);
+            }
+            return error() == 0;
+        }
+
+        void stop() noexcept {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            ready.notify_one();
+            flusher.join();
+        }
+
+        void run() noexcept {
+            std::unique_lock<std::mutex> lock(mutex);
+            for (;;) {
+                ready.wait(lock, [this] { return stopping || pending[0] || pending[1]; });
+                const int b = pending[0] ? 0 : pending[1] ? 1 : -1;
+                if (b < 0) {
+                    return;
+                }
+                const uint64_t offset = pending_offset[b];
+                lock.unlock();
+                const int e = error() == 0 ? obff_internal::io_write_all(fd, buffers[b], capacity, offset) : 0;
+                if (e != 0) {
+                    fail(e);
+                }
+                lock.lock();
+                pending[b] = false;
+                done.notify_one();
+            }
+        }
+
+        int fd;
+        uint8_t* memory;
+        uint8_t* buffers[2];
+        std::size_t capacity;
+        obff_internal::chunk_keys keys;
+        int active = 0;
+        std::size_t fill = 0;
+        uint64_t written = 0;
+        std::atomic<int> err{0};
+
+        std::mutex mutex;
+        std::condition_variable ready;
+        std::condition_variable done;
+        bool pending[2] = { false, false };
+        uint64_t pending_offset[2] = { 0, 0 };
+        bool stopping = false;
+        std::thread flusher;
+    };
+
+    std::unique_ptr<state> state_;
+    int error_ = 0;
+};
+
+// Streaming reader for files written by obf::encrypted_sink. read() pulls ciphertext
+// straight into the caller's buffer and decrypts it in place while it is still in cache.
+//
+//     auto in = obf::encrypted_source::open("dump.bin", secret);
+//     while (std::size_t n = in.read(buf, sizeof(buf))) { ... }
+//
+// read() returns 0 at the end of the stream and on error; error() tells them apart. Like
+// the sink, it never throws: open() needs neither heap memory nor a thread.
+class encrypted_source {
+public:
+    static encrypted_source open(const char* path, uint64_t secret) noexcept {
+        encrypted_source src;
+        src.fd_ = ::open(path, O_RDONLY | O_CLOEXEC);
+        if (src.fd_ < 0) {
+            src.error_ = errno;
+            return src;
+        }
+        obff_internal::stream_header h{};
+        if (pread(src.fd_, &h, sizeof(h), 0) != static_cast<ssize_t>(sizeof(h)) ||
+            h.magic != obff_internal::stream_header::magic_value || h.chunk != obff_internal::io_block) {
+            src.error_ = EINVAL;
+            ::close(src.fd_);
+            src.fd_ = -1;
+            return src;
+        }
+#if defined(POSIX_FADV_SEQUENTIAL)
+        posix_fadvise(src.fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+        src.keys_ = obff_internal::chunk_keys(obff_internal::mix_seed(secret ^ h.nonce));
+        return src;
+    }
+
+    encrypted_source() noexcept = default;
+    encrypted_source(encrypted_source&& other) noexcept { swap(other); }
+    encrypted_source& operator=(encrypted_source&& other) noexcept {
+        swap(other);
+        return *this;
+    }
+    ~encrypted_source() {
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+    }
+
+    bool valid() const noexcept { return fd_ >= 0; }
+    int error() const noexcept { return error_; }
+
+    // Plaintext offset of the next read.
+    uint64_t position() const noexcept { return position_; }
+
+    std::size_t read(void* out, std::size_t n) noexcept {
+        auto* dst = static_cast<uint8_t*>(out);
+        std::size_t total = 0;
+        while (fd_ >= 0 && total < n) {
+            const ssize_t r = pread(fd_, dst + total, n - total,
+                                    static_cast<off_t>(obff_internal::io_block + position_));
+            if (r < 0 && errno == EINTR) {
+                continue;
+            }
+            if (r <= 0) {
+                error_ = r < 0 ? errno : 0;
+                break;
+            }
+            keys_.apply(dst + total, dst + total, static_cast<std::size_t>(r), position_);
+            position_ += static_cast<uint64_t>(r);
+            total += static_cast<std::size_t>(r);
+        }
+        return total;
+    }
+
+private:
+    void swap(encrypted_source& other) noexcept {
+        std::swap(fd_, other.fd_);
+        std::swap(error_, other.error_);
+        std::swap(position_, other.position_);
+        std::swap(keys_, other.keys_);
+    }
+
+    int fd_ = -1;
+    int error_ = 0;
+    uint64_t position_ = 0;
+    obff_internal::chunk_keys keys_;
+};
+
+}
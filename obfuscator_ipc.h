@@ -0,0 +1,225 @@
+#pragma once
+#include "obfuscator.h"
+#if !defined(__linux__)
+#error "obfuscator_ipc.h relies on Linux memfd_create and shared mappings"
+#endif
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace obff_internal {
+
+// Shared state at the start of the memfd. The ring follows on the next page and is
+// mapped twice back to back, so a record that wraps is still one contiguous copy.
+struct ring_header {
+    static constexpr uint64_t magic_value = 0x4f42465350534331ull;
+
+    uint64_t magic;
+    uint64_t capacity;
+    uint64_t channel_nonce;
+    alignas(64) std::atomic<uint64_t> head;
+    alignas(64) std::atomic<uint64_t> tail;
+};
+
+constexpr std::size_t ring_page = 4096;
+// Records start on 32-byte boundaries and so do payloads, so the kernel's stores never
+// straddle a cache line.
+constexpr std::size_t ring_record_header = 32;
+
+inline std::size_t ring_record_size(std::size_t n) noexcept {
+    return (ring_record_header + n + 31) & ~std::size_t{31};
+}
+}
+
+namespace obf {
+
+// Single-producer / single-consumer message ring in a memfd, shared between processes
+// by passing fd() (SCM_RIGHTS, inheritance, pidfd_getfd). Payloads are encrypted while
+// they are copied in and decrypted while they are copied out, with the library's SIMD
+// key-stream kernel and a fresh key per message; the shared pages never hold plaintext.
+// Both ends must use the same 64-bit secret, e.g. one derived from an OBF constant.
+//
+//     auto tx = obf::shm_channel::create(1 << 24, secret);   // producer
+//     auto rx = obf::shm_channel::attach(fd, secret);        // consumer
+//     tx.try_send(buf, n);
+//     rx.try_receive(out, sizeof(out), n);
+//
+// A failed create/attach yields a channel whose valid() is false.
+class shm_channel {
+public:
+    // capacity is rounded up to a power of two of at least one page.
+    static shm_channel create(std::size_t capacity, uint64_t secret) noexcept {
+        std::size_t rounded = ring_page;
+        while (rounded < capacity) {
+            rounded *= 2;
+        }
+        capacity = rounded;
+        const int fd = static_cast<int>(syscall(SYS_memfd_create, "obf-channel", 0u));
+        if (fd < 0) {
+            return shm_channel();
+        }
+        if (ftruncate(fd, static_cast<off_t>(ring_page + capacity)) != 0) {
+            close(fd);
+            return shm_channel();
+        }
+        shm_channel ch = map(fd, capacity);
+        if (ch.valid()) {
+            ch.header_->magic = obff_internal::ring_header::magic_value;
+            ch.header_->capacity = capacity;
+            ch.header_->channel_nonce = obff_internal::mix_seed(obff_internal::process_secret() ^
+                                                                obff_internal::next_nonce());
+            ch.header_->head.store(0, std::memory_order_relaxed);
+            ch.header_->tail.store(0, std::memory_order_release);
+            ch.channel_key_ = obff_internal::mix_seed(secret ^ ch.header_->channel_nonce);
+        }
+        return ch;
+    }
+
+    // Takes ownership of fd.
+    static shm_channel attach(int fd, uint64_t secret) noexcept {
+        struct stat st;
+        if (fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) <= ring_page) {
+            close(fd);
+            return shm_channel();
+        }
+        shm_channel ch = map(fd, static_cast<std::size_t>(st.st_size) - ring_page);
+        if (ch.valid() && (ch.header_->magic != obff_internal::ring_header::magic_value ||
+                           ch.header_->capacity != ch.capacity_)) {
+            return shm_channel();
+        }
+        if (ch.valid()) {
+            ch.channel_key_ = obff_internal::mix_seed(secret ^ ch.header_->channel_nonce);
+            ch.cached_head_ = ch.cached_tail_ = ch.header_->tail.load(std::memory_order_acquire);
+        }
+        return ch;
+    }
+
+    shm_channel() noexcept = default;
+    shm_channel(shm_channel&& other) noexcept { swap(other); }
+    shm_channel& operator=(shm_channel&& other) noexcept {
+        swap(other);
+        return *this;
+    }
+    ~shm_channel() { release(); }
+
+    bool valid() const noexcept { return header_ != nullptr; }
+    int fd() const noexcept { return fd_; }
+    std::size_t capacity() const noexcept { return capacity_; }
+
+    // Largest payload a single message can carry.
+    std::size_t max_message() const noexcept { return capacity_ - obff_internal::ring_record_header; }
+
+    // Producer side. False if the ring has no room for the message right now, and always
+    // for n > max_message(), checked first so a huge n cannot wrap the record size.
+    bool try_send(const void* data, std::size_t n) noexcept {
+        if (n > max_message()) {
+            return false;
+        }
+        const std::size_t record = obff_internal::ring_record_size(n);
+        const uint64_t head = header_->head.load(std::memory_order_relaxed);
+        if (head + record - cached_tail_ > capacity_) {
+            cached_tail_ = header_->tail.load(std::memory_order_acquire);
+            if (head + record - cached_tail_ > capacity_) {
+                return false;
+            }
+        }
+        uint8_t* dst = ring_ + (head & (capacity_ - 1));
+        const uint64_t length = n;
+        std::memcpy(dst, &length, sizeof(length));
+        obff_internal::xor_key_stream(dst + obff_internal::ring_record_header, static_cast<const uint8_t*>(data), n,
+                                      obff_internal::stream_key(channel_key_, head));
+        header_->head.store(head + record, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. False if no message is waiting, or (with n set to its size and the
+    // message left in place) if it does not fit in `capacity` bytes. A length the producer
+    // cannot have written, over max_message() or past its head, comes from a broken or
+    // hostile peer: false with n = 0, and nothing is copied.
+    bool try_receive(void* out, std::size_t capacity, std::size_t& n) noexcept {
+        const uint64_t tail = header_->tail.load(std::memory_order_relaxed);
+        if (tail == cached_head_) {
+            cached_head_ = header_->head.load(std::memory_order_acquire);
+            if (tail == cached_head_) {
+                return false;
+            }
+        }
+        const uint8_t* src = ring_ + (tail & (capacity_ - 1));
+        uint64_t length;
+        std::memcpy(&length, src, sizeof(length));
+        if (length > max_message() || obff_internal::ring_record_size(length) > cached_head_ - tail) {
+            n = 0;
+            return false;
+        }
+        n = static_cast<std::size_t>(length);
+        if (n > capacity) {
+            return false;
+        }
+        obff_internal::xor_key_stream(static_cast<uint8_t*>(out), src + obff_internal::ring_record_header, n,
+                                      obff_internal::stream_key(channel_key_, tail));
+        header_->tail.store(tail + obff_internal::ring_record_size(n), std::memory_order_release);
+        return true;
+    }
+
+private:
+    // Reserves header page + 2 * capacity of address space, then maps the file over the
+    // first part and the ring pages again right behind it.
+    static shm_channel map(int fd, std::size_t capacity) noexcept {
+        shm_channel ch;
+        ch.fd_ = fd;
+        if ((capacity & (capacity - 1)) != 0) {
+            return ch;
+        }
+        const std::size_t span = ring_page + 2 * capacity;
+        void* base = mmap(nullptr, span, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (base == MAP_FAILED) {
+            return ch;
+        }
+        auto* b = static_cast<uint8_t*>(base);
+        if (mmap(b, ring_page + capacity, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED ||
+            mmap(b + ring_page + capacity, capacity, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd,
+                 static_cast<off_t>(ring_page)) == MAP_FAILED) {
+            munmap(base, span);
+            return ch;
+        }
+        ch.header_ = reinterpret_cast<obff_internal::ring_header*>(b);
+        ch.ring_ = b + ring_page;
+        ch.capacity_ = capacity;
+        return ch;
+    }
+
+    void release() noexcept {
+        if (header_ != nullptr) {
+            munmap(header_, ring_page + 2 * capacity_);
+            header_ = nullptr;
+        }
+        if (fd_ >= 0) {
+            close(fd_);
+            fd_ = -1;
+        }
+    }
+
+    void swap(shm_channel& other) noexcept {
+        std::swap(fd_, other.fd_);
+        std::swap(header_, other.header_);
+        std::swap(ring_, other.ring_);
+        std::swap(capacity_, other.capacity_);
+        std::swap(channel_key_, other.channel_key_);
+        std::swap(cached_head_, other.cached_head_);
+        std::swap(cached_tail_, other.cached_tail_);
+    }
+
+    static constexpr std::size_t ring_page = obff_internal::ring_page;
+
+    int fd_ = -1;
+    obff_internal::ring_header* header_ = nullptr;
+    uint8_t* ring_ = nullptr;
+    std::size_t capacity_ = 0;
+    uint64_t channel_key_ = 0;
+    uint64_t cached_head_ = 0;
+    uint64_t cached_tail_ = 0;
+};
+
+}
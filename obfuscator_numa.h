@@ -0,0 +1,198 @@
+#pragma once
+#include "obfuscator.h"
+#if !defined(__linux__)
+#error "obfuscator_numa.h relies on Linux getcpu / mbind"
+#endif
+#include <cstring>
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace obff_internal {
+
+constexpr std::size_t max_numa_nodes = 64;
+
+inline unsigned current_node() noexcept {
+    unsigned cpu = 0;
+    unsigned node = 0;
+    if (syscall(SYS_getcpu, &cpu, &node, nullptr) != 0) {
+        return 0;
+    }
+    return node % max_numa_nodes;
+}
+
+// Threads cache their node and refresh it every 4096 lookups, so a migrated thread drifts
+// back to local replicas without paying a syscall per read.
+inline unsigned this_thread_node() noexcept {
+    thread_local unsigned node = 0;
+    thread_local unsigned countdown = 0;
+    if (countdown-- == 0) {
+        node = current_node();
+        countdown = 4096;
+    }
+    return node;
+}
+
+// Bump allocator over 2 MiB chunks whose pages are bound to one node. The first word of
+// each chunk links to the previous one so the whole arena can be wiped. Allocation only
+// happens once per string and node, so a spinlock is plenty.
+class node_arena {
+public:
+    static constexpr std::size_t chunk_size = std::size_t{2} << 20;
+    static constexpr std::size_t header = 64;
+
+    void* alloc(unsigned node, std::size_t bytes) noexcept {
+        bytes = (bytes + 63) & ~std::size_t{63};
+        while (lock_.test_and_set(std::memory_order_acquire)) {
+            cpu_relax();
+        }
+        if (chunk_ == nullptr || used_ + bytes > chunk_bytes_) {
+            grow(node, bytes);
+        }
+        void* p = nullptr;
+        if (chunk_ != nullptr) {
+            p = chunk_ + used_;
+            used_ += bytes;
+        }
+        lock_.clear(std::memory_order_release);
+        return p;
+    }
+
+    void wipe() noexcept {
+        while (lock_.test_and_set(std::memory_order_acquire)) {
+            cpu_relax();
+        }
+        for (char* c = chunk_; c != nullptr; c = *reinterpret_cast<char**>(c)) {
+            const std::size_t len = *reinterpret_cast<std::size_t*>(c + sizeof(char*));
+            std::memset(c + header, 0, len - header);
+            __builtin___clear_cache(c + header, c + len);
+        }
+        lock_.clear(std::memory_order_release);
+    }
+
+private:
+    void grow(unsigned node, std::size_t bytes) noexcept {
+        const std::size_t len = std::max(chunk_size, bytes + header);
+        void* mem = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mem == MAP_FAILED) {
+            return;
+        }
+        // Bound before first touch, so every page faults in on `node`. Kernels without
+        // NUMA reject the call and the chunk simply stays wherever it lands.
+        unsigned long mask[max_numa_nodes / (8 * sizeof(unsigned long))] = {};
+        mask[node / (8 * sizeof(unsigned long))] = 1ul << (node % (8 * sizeof(unsigned long)));
+        syscall(SYS_mbind, mem, len, MPOL_BIND, mask, max_numa_nodes + 1, 0);
+        char* c = static_cast<char*>(mem);
+        *reinterpret_cast<char**>(c) = chunk_;
+        *reinterpret_cast<std::size_t*>(c + sizeof(char*)) = len;
+        chunk_ = c;
+        chunk_bytes_ = len;
+        used_ = header;
+    }
+
+    std::atomic_flag lock_ = ATOMIC_FLAG_INIT;
+    char* chunk_ = nullptr;
+    std::size_t chunk_bytes_ = 0;
+    std::size_t used_ = 0;
+};
+
+inline node_arena numa_arenas[max_numa_nodes];
+
+}
+
+namespace obf {
+
+// One decrypted replica of a string per NUMA node, created on first use from that node.
+// The static itself stays encrypted; readers always get the copy on their own node. The
+// replicas of a string count as one tracked site: obf::wipe_decrypted and the fork wipe
+// policy zero them, and the next get() on a node decrypts into the same node memory
+// again, so wipe cycles do not grow the arena. Like a string, the replicas are wiped
+// at exit. If no node memory can be mapped, get() decrypts the static in place instead.
+template<typename XS>
+class numa_replicas {
+public:
+    using char_type = typename XS::char_type;
+
+    numa_replicas() = default;
+    numa_replicas(const numa_replicas&) = delete;
+    numa_replicas& operator=(const numa_replicas&) = delete;
+
+    ~numa_replicas() {
+        if (obff_internal::exit_wipe_needed(slot_)) {
+            zeroize();
+        }
+    }
+
+    const char_type* get(XS& xs) noexcept {
+        const unsigned node = obff_internal::this_thread_node();
+        const char_type* p = replicas_[node].load(std::memory_order_acquire);
+        return p != nullptr ? p : make(xs, node);
+    }
+
+    // Zeroes every replica and unpublishes it; the node memory is kept for the next
+    // get(). Like wiping a string, it must not race readers.
+    void zeroize() noexcept {
+        for (auto& replica : replicas_) {
+            if (char_type* p = replica.exchange(nullptr, std::memory_order_acq_rel)) {
+                std::memset(p, 0, sizeof(char_type) * XS::Length);
+                __builtin___clear_cache(reinterpret_cast<char*>(p), reinterpret_cast<char*>(p + XS::Length));
+            }
+        }
+        obff_internal::track_wiped(slot_);
+    }
+
+    void reencrypt() noexcept {
+        zeroize();
+    }
+
+private:
+    // Under lock_, so a node's memory is allocated once and filled by one thread at a time.
+    const char_type* make(XS& xs, unsigned node) noexcept {
+        while (lock_.test_and_set(std::memory_order_acquire)) {
+            obff_internal::cpu_relax();
+        }
+        char_type* p = replicas_[node].load(std::memory_order_acquire);
+        if (p == nullptr) {
+            p = memory_[node];
+            if (p == nullptr) {
+                p = static_cast<char_type*>(
+                    obff_internal::numa_arenas[node].alloc(node, sizeof(char_type) * XS::Length));
+                memory_[node] = p;
+            }
+            if (p != nullptr) {
+                xs.decrypt_to(p);
+                replicas_[node].store(p, std::memory_order_release);
+                obff_internal::track_decrypted(slot_, this, &obff_internal::reencrypt_site<numa_replicas>);
+            }
+        }
+        lock_.clear(std::memory_order_release);
+        return p != nullptr ? p : xs.decrypt();
+    }
+
+    std::atomic<char_type*> replicas_[obff_internal::max_numa_nodes] = {};
+    char_type* memory_[obff_internal::max_numa_nodes] = {};
+    std::atomic_flag lock_ = ATOMIC_FLAG_INIT;
+    uint32_t slot_ = 0;
+};
+
+// Zeroes every node-local replica. Replicas stay allocated and read back as empty strings.
+inline void numa_wipe() noexcept {
+    for (auto& arena : obff_internal::numa_arenas) {
+        arena.wipe();
+    }
+}
+
+}
+
+#define OBF_NUMA(str) []() -> const char* { \
+    static obff_internal::XorString<sizeof(str), obff_internal::literal_seed(str)> xs(str); \
+    static obf::numa_replicas<std::remove_reference_t<decltype(xs)>> replicas; \
+    return replicas.get(xs); \
+}()
+
+#define OBF_W_NUMA(str) []() -> const wchar_t* { \
+    static obff_internal::XorWString<sizeof(str)/sizeof(wchar_t), obff_internal::literal_seed(str)> xs(str); \
+    static obf::numa_replicas<std::remove_reference_t<decltype(xs)>> replicas; \
+    return replicas.get(xs); \
+}()
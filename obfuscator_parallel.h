@@ -0,0 +1,374 @@
+#pragma once
+#include "obfuscator.h"
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+namespace obff_internal {
+
+// Identifies the process that started a thread, so fork() children can tell that the
+// thread did not come along.
+inline long process_id() noexcept {
+#if defined(__unix__) || defined(__APPLE__)
+    return static_cast<long>(::getpid());
+#else
+    return 0;
+#endif
+}
+
+// Each worker owns a contiguous slice of the task range and claims from its front.
+// Once its own slice runs dry it steals from the others, so uneven tasks still balance.
+struct alignas(64) task_slice {
+    std::atomic<std::size_t> next{0};
+    std::size_t end = 0;
+};
+
+inline bool claim_task(task_slice& slice, std::size_t& task) noexcept {
+    if (slice.next.load(std::memory_order_relaxed) >= slice.end) {
+        return false;
+    }
+    task = slice.next.fetch_add(1, std::memory_order_relaxed);
+    return task < slice.end;
+}
+
+// Threads for parallel_for, started on first use and then kept, so a call costs a wake-up
+// per helper rather than a thread spawn. One parallel_for holds the pool at a time; a
+// concurrent or nested caller runs its tasks on its own thread instead. The threads are
+// detached and the pool is never freed, so exit does not wait for them. A fork() child
+// gets a pool of its own: the parent's threads did not come along.
+class task_pool {
+public:
+    using job_fn = void (*)(void* ctx, std::size_t worker) noexcept;
+
+    // Null only if the pool could not be allocated.
+    static task_pool* instance() noexcept {
+        static std::atomic<task_pool*> current{nullptr};
+        task_pool* pool = current.load(std::memory_order_acquire);
+        while (pool == nullptr || pool->owner_ != process_id()) {
+            auto* fresh = new (std::nothrow) task_pool;
+            if (fresh == nullptr) {
+                return nullptr;
+            }
+            // A parent's pool is leaked: its locks may be held by threads that are gone.
+            if (current.compare_exchange_strong(pool, fresh, std::memory_order_acq_rel)) {
+                return fresh;
+            }
+            delete fresh;
+        }
+        return pool;
+    }
+
+    // Starts job(ctx, w) for w in [1, helpers] on pool threads, spawning threads as needed;
+    // if the system refuses one, fewer run and helpers says how many. Returns false, with
+    // nothing started, when the pool is taken or has no threads at all. After true, the
+    // caller must wait().
+    bool run(std::size_t& helpers, job_fn job, void* ctx) noexcept {
+        if (!busy_.try_lock()) {
+            return false;
+        }
+        grow(helpers);
+        helpers = std::min(helpers, threads_);
+        if (helpers == 0) {
+            busy_.unlock();
+            return false;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            job_ = job;
+            ctx_ = ctx;
+            wanted_ = helpers;
+            joined_ = 0;
+            done_ = 0;
+            ++generation_;
+        }
+        wake_.notify_all();
+        return true;
+    }
+
+    // Returns once every helper of the last successful run() has finished.
+    void wait() noexcept {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            finished_.wait(lock, [this] { return done_ == wanted_; });
+        }
+        busy_.unlock();
+    }
+
+private:
+    task_pool() = default;
+
+    // Runs with busy_ held, so generation_ cannot move: a new thread must not skip the
+    // job posted right after it was spawned.
+    void grow(std::size_t helpers) noexcept {
+        for (; threads_ < helpers; ++threads_) {
+            try {
+                std::thread([this, seen = generation_] { serve(seen); }).detach();
+            } catch (...) {
+                return;
+            }
+        }
+    }
+
+    void serve(uint64_t seen) noexcept {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            wake_.wait(lock, [&] { return generation_ != seen; });
+            seen = generation_;
+            if (joined_ == wanted_) {
+                continue;
+            }
+            const std::size_t worker = ++joined_;
+            lock.unlock();
+            job_(ctx_, worker);
+            lock.lock();
+            if (++done_ == wanted_) {
+                finished_.notify_one();
+            }
+        }
+    }
+
+    const long owner_ = process_id();
+    std::mutex busy_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable finished_;
+    std::size_t threads_ = 0;
+    uint64_t generation_ = 0;
+    job_fn job_ = nullptr;
+    void* ctx_ = nullptr;
+    std::size_t wanted_ = 0;
+    std::size_t joined_ = 0;
+    std::size_t done_ = 0;
+};
+
+// Runs fn(task) for every task in [0, tasks) on `workers` threads, the caller included.
+// The helpers come from task_pool; when it is taken, or cannot start threads, the tasks
+// run on the caller alone. Throws only what fn throws, and fn must not throw on a helper.
+template<typename F>
+void parallel_for(std::size_t tasks, std::size_t workers, F&& fn) {
+    if (workers == 0) {
+        workers = std::max(1u, std::thread::hardware_concurrency());
+    }
+    workers = std::min(workers, tasks);
+    std::unique_ptr<task_slice[]> slices(workers > 1 ? new (std::nothrow) task_slice[workers] : nullptr);
+    if (!slices) {
+        for (std::size_t t = 0; t < tasks; ++t) {
+            fn(t);
+        }
+        return;
+    }
+    for (std::size_t w = 0; w < workers; ++w) {
+        slices[w].next.store(tasks * w / workers, std::memory_order_relaxed);
+        slices[w].end = tasks * (w + 1) / workers;
+    }
+
+    // Whoever finishes its own slice moves on to the others', so the slices of helpers
+    // that never started are drained by the rest.
+    auto run = [&](std::size_t self) {
+        std::size_t task;
+        for (std::size_t k = 0; k < workers; ++k) {
+            task_slice& slice = slices[(self + k) % workers];
+            while (claim_task(slice, task)) {
+                fn(task);
+            }
+        }
+    };
+    using run_type = decltype(run);
+
+    struct join_helpers {
+        task_pool* pool;
+        ~join_helpers() {
+            if (pool != nullptr) {
+                pool->wait();
+            }
+        }
+    };
+    task_pool* pool = task_pool::instance();
+    std::size_t helpers = workers - 1;
+    const bool pooled = pool != nullptr && pool->run(helpers, [](void* ctx, std::size_t w) noexcept {
+        (*static_cast<run_type*>(ctx))(w);
+    }, &run);
+    const join_helpers join{ pooled ? pool : nullptr };
+    run(0);
+}
+
+// One background thread that decrypts strings handed to obf::decrypt_ahead. If the
+// request thread gets there first, decrypt_once makes one of them wait for the other.
+// As with task_pool, a fork() child gets a worker of its own: the parent's thread did not
+// come along, so its worker is leaked untouched. Each process stops and joins its own
+// worker at exit, after the queue has drained.
+class ahead_worker {
+public:
+    static ahead_worker& instance() {
+        ahead_worker* worker = current().load(std::memory_order_acquire);
+        while (worker == nullptr || worker->owner_ != process_id()) {
+            auto* fresh = new ahead_worker;
+            if (current().compare_exchange_strong(worker, fresh, std::memory_order_acq_rel)) {
+                std::atexit([] {
+                    ahead_worker* w = current().load(std::memory_order_acquire);
+                    if (w != nullptr && w->owner_ == process_id()) {
+                        w->stop();
+                    }
+                });
+                return *fresh;
+            }
+            delete fresh;
+        }
+        return *worker;
+    }
+
+    void post(void* object, void (*decrypt)(void*) noexcept) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            queue_.push_back({ object, decrypt, nullptr });
+        }
+        ready_.notify_one();
+    }
+
+    ~ahead_worker() { stop(); }
+
+private:
+    ahead_worker() : thread_([this] { run(); }) {}
+
+    static std::atomic<ahead_worker*>& current() noexcept {
+        static std::atomic<ahead_worker*> worker{nullptr};
+        return worker;
+    }
+
+    // Idempotent: a child inherits its parent's exit handler next to its own.
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        ready_.notify_one();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            ready_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+            if (queue_.empty()) {
+                return;
+            }
+            const site_entry job = queue_.front();
+            queue_.pop_front();
+            lock.unlock();
+            job.decrypt(job.object);
+            lock.lock();
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    std::deque<site_entry> queue_;
+    bool stop_ = false;
+    const long owner_ = process_id();
+    std::thread thread_;
+};
+
+#if defined(OBF_REGISTRY)
+// A site's destructor is only registered once control first passes through its
+// declaration, so a site warmed before its first use has nobody to wipe it at exit.
+// Re-encrypts whatever is still decrypted by then; strings already destroyed cleared
+// their bit, and a fork child leaves its parent's plaintext alone, as exit_wipe_needed does.
+inline void wipe_warmed() noexcept {
+    for (std::size_t shard = 0; shard < state_tracker::shard_count; ++shard) {
+        for (std::size_t w = 0; w < 8; ++w) {
+            uint64_t bits = tracker.shards[shard].words[w].load(std::memory_order_acquire);
+            if (fork_inherited != nullptr) {
+                bits &= ~fork_inherited[shard * 8 + w];
+            }
+            for (; bits != 0; bits &= bits - 1) {
+                const auto& site =
+                    tracker.site(state_tracker::slot_of(shard, w, static_cast<unsigned>(__builtin_ctzll(bits))));
+                site.reencrypt(site.object);
+            }
+        }
+    }
+}
+#endif
+
+}
+
+namespace obf {
+
+// Prefetches xs and queues its decryption on a background thread, for strings that are
+// known to be needed a little later on the current path.
+template<typename XS>
+void decrypt_ahead(XS& xs) {
+    xs.prefetch();
+    obff_internal::ahead_worker::instance().post(&xs, &obff_internal::decrypt_site<XS>);
+}
+
+#if defined(OBF_REGISTRY)
+// Decrypts every registered site on `parallelism` threads, 0 meaning one per hardware
+// thread, taken from the pool parallel_decrypt uses too. Sites are sorted by address and
+// handed out in runs of neighbours, so each task walks a compact stretch of memory.
+// Returns the number of sites visited.
+inline std::size_t warm(std::size_t parallelism = 0) {
+    constexpr std::size_t chunk = 64;
+    static const bool wipe_registered = std::atexit(&obff_internal::wipe_warmed) == 0;
+    (void)wipe_registered;
+    std::vector<obff_internal::site_entry*> sites;
+    for (auto* e = obff_internal::site_list.load(std::memory_order_acquire); e; e = e->next) {
+        sites.push_back(e);
+    }
+    std::sort(sites.begin(), sites.end(), [](const auto* a, const auto* b) {
+        return std::less<void*>()(a->object, b->object);
+    });
+    obff_internal::parallel_for((sites.size() + chunk - 1) / chunk, parallelism, [&](std::size_t c) {
+        const std::size_t end = std::min(sites.size(), (c + 1) * chunk);
+        for (std::size_t i = c * chunk; i < end; ++i) {
+            sites[i]->decrypt(sites[i]->object);
+        }
+    });
+    return sites.size();
+}
+#else
+// Without -DOBF_REGISTRY no site is registered and there would be nothing to warm.
+template<bool Registry = false>
+std::size_t warm(std::size_t = 0) {
+    static_assert(Registry, "obf::warm needs every TU built with -DOBF_REGISTRY");
+    return 0;
+}
+#endif
+
+// Decrypts a large string (OBF_LARGE_REF) with its blocks spread over `parallelism`
+// threads. Tasks are runs of whole blocks, so every range starts on a cache line and
+// runs the SIMD kernel on its own key. Payloads below min_parallel bytes stay on the
+// calling thread: waking the parked pool threads costs several microseconds per call,
+// and the first call also starts them, tens of microseconds each. Never throws: if no thread
+// can be had, the whole payload is decrypted on the caller, as xs.decrypt() would.
+template<typename CharT, typename Lit, std::size_t Seed>
+CharT* parallel_decrypt(obff_internal::XorLargeStringBase<CharT, Lit, Seed>& xs,
+                        std::size_t parallelism = 0) noexcept {
+    using XS = obff_internal::XorLargeStringBase<CharT, Lit, Seed>;
+    constexpr std::size_t min_parallel = std::size_t{1} << 20;
+    constexpr std::size_t blocks_per_task = 16;
+    if (sizeof(CharT) * XS::N < min_parallel) {
+        return xs.decrypt();
+    }
+    obff_internal::decrypt_once(xs.state, [&] {
+        constexpr std::size_t tasks = (XS::Blocks + blocks_per_task - 1) / blocks_per_task;
+        obff_internal::parallel_for(tasks, parallelism, [&](std::size_t t) {
+            xs.xor_blocks(t * blocks_per_task, std::min(XS::Blocks, (t + 1) * blocks_per_task));
+        });
+        obff_internal::track_decrypted(xs.slot, &xs, &obff_internal::reencrypt_site<XS>);
+    });
+    return xs.data();
+}
+
+}
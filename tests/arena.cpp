@@ -0,0 +1,52 @@
+// obf::request_arena: decrypted copies land in aligned slots, the statics stay encrypted,
+// a full arena says so, and reset() wipes everything it handed out.
+#include "obfuscator.h"
+#include "tests/check.h"
+#include <cstdint>
+#include <cstring>
+#include <cwchar>
+#include <new>
+
+int main() {
+    obf::request_arena<256> arena;
+    auto& user = OBF_REF("svc-user");
+    const char* a = arena.decrypt(user);
+    CHECK(a != nullptr && std::strcmp(a, "svc-user") == 0);
+    CHECK(reinterpret_cast<std::uintptr_t>(a) % 32 == 0);
+    CHECK(user.c_str() == nullptr);
+
+    const auto v = arena.view(OBF_W_REF(L"wide-thing"));
+    CHECK(v == L"wide-thing");
+    const auto s = obf::to_pmr_string(OBF_REF("X-Api-Key-with-a-long-value-beyond-the-sso-buffer"), &arena);
+    CHECK(s == "X-Api-Key-with-a-long-value-beyond-the-sso-buffer");
+    CHECK(arena.used() > 0 && arena.used() + arena.remaining() == 256);
+
+    obf::secret<16> sec;
+    char in[5] = "abcd";
+    sec.ingest(in, 4);
+    const uint8_t* p = arena.decrypt(sec);
+    CHECK(p != nullptr && std::memcmp(p, "abcd", 4) == 0);
+
+    CHECK(arena.decrypt(OBF_LARGE_REF("0123456789012345678901234567890123456789012345678901234567890123456789"
+                                      "0123456789012345678901234567890123456789012345678901234567890123456789"
+                                      "0123456789012345678901234567890123456789012345678901234567890123456789"
+                                      "0123456789012345678901234567890123456789012345678901234567890123456789")) == nullptr);
+    bool threw = false;
+    try {
+        std::pmr::string t(300, 'x', &arena);
+    } catch (const std::bad_alloc&) {
+        threw = true;
+    }
+    CHECK(threw);
+
+    const auto* raw = reinterpret_cast<const unsigned char*>(a);
+    arena.reset();
+    unsigned char nz = 0;
+    for (std::size_t i = 0; i < 64; ++i) {
+        nz |= raw[i];
+    }
+    CHECK(nz == 0);
+    CHECK(arena.used() == 0 && arena.remaining() == 256);
+    CHECK(std::strcmp(arena.decrypt(user), "svc-user") == 0);
+    return obf_test::result();
+}
@@ -0,0 +1,26 @@
+#pragma once
+// Minimal assertion helper for the tests in this directory: every failed CHECK prints its
+// location and the test's exit status becomes 1. Built and run by tests/run.sh.
+#include <cstdio>
+#include <cstdlib>
+
+namespace obf_test {
+
+inline int failures = 0;
+
+inline int result() noexcept {
+    if (failures != 0) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+    }
+    return failures == 0 ? 0 : 1;
+}
+
+}
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            ++obf_test::failures; \
+        } \
+    } while (0)
@@ -0,0 +1,48 @@
+// Readers of the ciphertext (equals, compare, decrypt_to) racing the first decrypt(): each
+// sees either the ciphertext or the finished plaintext, never a half-converted buffer.
+// Build with -fsanitize=thread to check the storage for data races as well.
+#include "obfuscator.h"
+#include "tests/check.h"
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#define SECRET "a string long enough to span several key-stream rounds, 0123456789abcdef"
+
+int main() {
+    for (int round = 0; round < 200; ++round) {
+        auto& xs = []() -> auto& {
+            static obff_internal::XorString<sizeof(SECRET), obff_internal::literal_seed(SECRET)> s(SECRET);
+            return s;
+        }();
+        if (round != 0) {
+            xs.reencrypt();
+        }
+        std::atomic<int> started{0};
+        std::atomic<int> bad{0};
+        std::vector<std::thread> readers;
+        for (int r = 0; r < 3; ++r) {
+            readers.emplace_back([&] {
+                ++started;
+                for (int i = 0; i < 200; ++i) {
+                    char out[sizeof(SECRET)];
+                    xs.decrypt_to(out);
+                    bad += std::memcmp(out, SECRET, sizeof(SECRET)) != 0;
+                    bad += !xs.equals(SECRET);
+                    bad += xs.compare("a string") <= 0;
+                }
+            });
+        }
+        while (started.load() != 3) {
+            std::this_thread::yield();
+        }
+        const char* p = xs.decrypt();
+        for (auto& t : readers) {
+            t.join();
+        }
+        CHECK(bad.load() == 0);
+        CHECK(std::strcmp(p, SECRET) == 0);
+    }
+    return obf_test::result();
+}
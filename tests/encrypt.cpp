@@ -0,0 +1,70 @@
+// tools/obf_encrypt.cpp: the rewritten call carries the same seed and ciphertext as the
+// header path, and the rewritten source keeps its original file name and line numbers.
+#define main obf_encrypt_main
+#include "tools/obf_encrypt.cpp"
+#undef main
+#include "tests/check.h"
+#include <cstdio>
+
+namespace {
+
+template<typename XS>
+std::string expected_call(const char* name, const XS& xs) {
+    char buf[64];
+    std::snprintf(buf, sizeof(buf), "(%zu, %zuu, 0x%llxull", XS::Length, XS::seed,
+                  static_cast<unsigned long long>(xs.hash));
+    std::string call = std::string(name) + buf;
+    for (auto c : xs.data) {
+        std::snprintf(buf, sizeof(buf), ", '\\x%llx'",
+                      static_cast<unsigned long long>(static_cast<unsigned char>(c)));
+        call += buf;
+    }
+    return call + ')';
+}
+
+}
+
+int main() {
+    auto& abc = OBF_REF("abc");
+    auto& abd = OBF_REF("abd");
+    static const obff_internal::XorString<2, 7> x7("x");
+    using ABC = std::remove_reference_t<decltype(abc)>;
+    using ABD = std::remove_reference_t<decltype(abd)>;
+    CHECK(ABC::seed == obff_internal::literal_seed("abc"));
+    CHECK(ABC::seed != ABD::seed);
+
+    const std::string src = "int f() {\n    return g(OBF(\"abc\"), OBF_SEED(\"x\",\n 7)) + 1;\n}\n";
+    std::string out;
+    CHECK(rewrite(src, "in.cpp", out) == 2);
+    const std::string want = "#line 1 \"in.cpp\"\nint f() {\n    return g(" + expected_call("OBF_CIPHER", abc) +
+                             ", " + expected_call("OBF_CIPHER", x7) + "\n) + 1;\n}\n";
+    CHECK(out == want);
+    if (out != want) {
+        std::fputs(out.c_str(), stderr);
+    }
+
+    // Inside another macro's arguments there must be no directive: only the leading #line.
+    out.clear();
+    CHECK(rewrite("assert(std::strcmp(OBF(\"a\"), \"a\") == 0);\nCALL(OBF(\n\"x\"));\n", "args.cpp", out) == 2);
+    CHECK(out.find('#', 1) == std::string::npos);
+    CHECK(std::count(out.begin(), out.end(), '\n') == 4);
+
+    // OBF calls inside raw strings are text, whatever the prefix and delimiter.
+    const std::string raw = "std::puts(R\"d(raw \"OBF(\"x\")\" end)d\");\n"
+                            "auto w = LR\"(OBF_W(L\"y\"))\"; auto u = u8R\"xy(\")\" OBF(\"z\"))xy\";\n";
+    out.clear();
+    CHECK(rewrite(raw, "raw.cpp", out) == 0);
+    CHECK(out == "#line 1 \"raw.cpp\"\n" + raw);
+
+    // A raw string does not hide the calls after it.
+    out.clear();
+    CHECK(rewrite("f(R\"(a)\", OBF(\"x\"));\n", "after.cpp", out) == 1);
+
+    // Digit separators are part of the number, not the start of a character literal.
+    out.clear();
+    CHECK(rewrite("int n = 1'000'000 + 0xff'ff + 0b1'0 + 1.5'0;\nf(OBF(\"x\"), u8'a', '\\'');\n",
+                  "digits.cpp", out) == 1);
+    CHECK(out.find("OBF_CIPHER") != std::string::npos);
+    CHECK(out.find("u8'a', '\\'');") != std::string::npos);
+    return obf_test::result();
+}
@@ -0,0 +1,36 @@
+// obf::argv / obf::envp: one block holding the pointer array and the strings, usable as
+// posix_spawn arguments, and empty once wiped.
+#include "obfuscator.h"
+#include "tests/check.h"
+#include <cstdint>
+#include <cstring>
+#include <spawn.h>
+#include <sys/wait.h>
+
+int main() {
+    obf::argv args{ OBF_REF("/bin/sh"), OBF_REF("-c"), OBF_REF("test \"$HELPER_MODE\" = strict && test \"$1\" = x"),
+                    OBF_REF("sh"), OBF_REF("x") };
+    obf::envp env{ OBF_REF("HELPER_MODE=strict") };
+    CHECK(args.size() == 5 && env.size() == 1);
+    CHECK(std::strcmp(args[0], "/bin/sh") == 0 && std::strcmp(args[4], "x") == 0);
+    CHECK(args.data()[5] == nullptr && env.data()[1] == nullptr);
+
+    // Pointer array first, then the strings, each on a 32-byte boundary inside the object.
+    const auto* lo = reinterpret_cast<const unsigned char*>(&args);
+    const auto* hi = lo + sizeof(args);
+    for (std::size_t i = 0; i < args.size(); ++i) {
+        const auto* p = reinterpret_cast<const unsigned char*>(args[i]);
+        CHECK(p > lo && p < hi);
+        CHECK(reinterpret_cast<std::uintptr_t>(p) % 32 == 0);
+    }
+
+    pid_t pid = 0;
+    CHECK(posix_spawn(&pid, args[0], nullptr, nullptr, args, env) == 0);
+    int status = 0;
+    CHECK(waitpid(pid, &status, 0) == pid);
+    CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    args.wipe();
+    CHECK(args.data()[0] == nullptr);
+    return obf_test::result();
+}
@@ -0,0 +1,76 @@
+// obf::set_fork_policy: what a fork() child finds in the strings its parent decrypted.
+// Each policy is checked in a child, which reports through its exit status.
+#include "obfuscator.h"
+#include "obfuscator_fork.h"
+#include "tests/check.h"
+#include <cstring>
+#include <sys/wait.h>
+
+namespace {
+
+auto& inherited() {
+    return OBF_REF("decrypted by the parent before fork");
+}
+
+auto& fresh() {
+    return OBF_REF("first decrypted in the child");
+}
+
+bool reads_plaintext() {
+    return std::strcmp(inherited().decrypt(), "decrypted by the parent before fork") == 0;
+}
+
+template<typename F>
+bool in_child(obf::fork_policy policy, F&& checks) {
+    obf::set_fork_policy(policy);
+    const pid_t pid = fork();
+    if (pid == 0) {
+        const int before = obf_test::failures;
+        checks();
+        _exit(obf_test::failures == before ? 0 : 1);
+    }
+    int status = 0;
+    return pid > 0 && waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+}
+
+int main() {
+    CHECK(reads_plaintext());
+    const uint64_t parent_secret = obff_internal::process_secret();
+
+    CHECK(in_child(obf::fork_policy::inherit, [] {
+        CHECK(inherited().c_str() != nullptr);
+        CHECK(reads_plaintext());
+        CHECK(obff_internal::exit_wipe_needed(inherited().slot));
+    }));
+
+    CHECK(in_child(obf::fork_policy::share, [] {
+        CHECK(inherited().c_str() != nullptr);
+        CHECK(reads_plaintext());
+        // Inherited plaintext is left to the parent's pages; the child's own is wiped.
+        CHECK(!obff_internal::exit_wipe_needed(inherited().slot));
+        CHECK(std::strcmp(fresh().decrypt(), "first decrypted in the child") == 0);
+        CHECK(obff_internal::exit_wipe_needed(fresh().slot));
+    }));
+
+    CHECK(in_child(obf::fork_policy::wipe, [] {
+        CHECK(inherited().c_str() == nullptr);
+        CHECK(std::memcmp(inherited().data.data(), "decrypted by the parent before fork",
+                          sizeof("decrypted by the parent before fork")) != 0);
+        CHECK(reads_plaintext());
+    }));
+
+    CHECK(in_child(obf::fork_policy::rekey, [parent_secret] {
+        CHECK(obff_internal::process_secret() != parent_secret);
+        CHECK(reads_plaintext());
+        CHECK(!obff_internal::exit_wipe_needed(inherited().slot));
+    }));
+
+    // The policies only act in children: the parent's copy is untouched throughout.
+    CHECK(inherited().c_str() != nullptr);
+    CHECK(reads_plaintext());
+    CHECK(obff_internal::process_secret() == parent_secret);
+    CHECK(fresh().c_str() == nullptr);
+    return obf_test::result();
+}
@@ -0,0 +1,46 @@
+// obf::getenv: finds variables without decrypting the name, rejects prefixes and longer
+// names, and copes with entries shorter than two bytes (an empty entry sits in environ
+// here, and the scan must not read past its terminator, nor past a short entry whose
+// first bytes match a long name).
+#include "obfuscator.h"
+#include "tests/check.h"
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+
+int main() {
+    static char empty[] = "";
+    static char api[] = "API_TOKEN=s3cret";
+    static char api_long[] = "API_TOKENS=no";
+    static char one[] = "A=1";
+    // Exactly-sized heap copies, so ASan builds catch any read past an entry's end.
+    char* short_db = strdup("DA=x");
+    char* db = strdup("DATABASE_PASSWORD_PRIMARY=hunter2");
+    char* env[] = { empty, api_long, short_db, api, one, db, nullptr };
+    char** saved = ::environ;
+    ::environ = env;
+
+    auto& name = OBF_REF("API_TOKEN");
+    const char* v = obf::getenv(name);
+    CHECK(v != nullptr && std::strcmp(v, "s3cret") == 0);
+    CHECK(name.c_str() == nullptr);
+    const char* a = obf::getenv(OBF_REF("A"));
+    CHECK(a != nullptr && std::strcmp(a, "1") == 0);
+    CHECK(obf::getenv(OBF_REF("API_TOKE")) == nullptr);
+    CHECK(obf::getenv(OBF_REF("API_TOKENSX")) == nullptr);
+    CHECK(obf::getenv(OBF_REF("MISSING")) == nullptr);
+
+    // Decrypted names take the plaintext path and give the same answers.
+    name.decrypt();
+    CHECK(obf::getenv(name) == v);
+
+    // Names of 16 bytes and more take the SSE2 compare, which must stop at a shorter entry.
+    const char* pw = obf::getenv(OBF_REF("DATABASE_PASSWORD_PRIMARY"));
+    CHECK(pw != nullptr && std::strcmp(pw, "hunter2") == 0);
+    CHECK(obf::getenv(OBF_REF("DATABASE_PASSWORD_PRIMARX")) == nullptr);
+
+    ::environ = saved;
+    std::free(short_db);
+    std::free(db);
+    return obf_test::result();
+}
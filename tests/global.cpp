@@ -0,0 +1,32 @@
+// OBF_GLOBAL family: constant-initialized globals, eager decryption during static init,
+// and one key stream per global even when several are declared on the same line.
+#include "obfuscator.h"
+#include "tests/check.h"
+#include <cstring>
+#include <cwchar>
+
+OBF_GLOBAL(kFirst, "CreateRemoteThread"); OBF_GLOBAL(kSecond, "VirtualAllocExNuma");
+OBF_GLOBAL(kSame, "CreateRemoteThread");
+OBF_W_GLOBAL(kWide, L"ntdll.dll");
+OBF_GLOBAL_EAGER(kEager, "decrypted during static init");
+
+int main() {
+    CHECK(kEager.c_str() != nullptr && std::strcmp(kEager.c_str(), "decrypted during static init") == 0);
+    CHECK(kFirst.c_str() == nullptr);
+
+    // Same line, same length: the ciphertexts must not XOR to the XOR of the plaintexts.
+    bool differ = false;
+    for (std::size_t i = 0; i < sizeof("CreateRemoteThread"); ++i) {
+        differ |= (kFirst.data[i] ^ kSecond.data[i]) != ("CreateRemoteThread"[i] ^ "VirtualAllocExNuma"[i]);
+    }
+    CHECK(differ);
+    CHECK(std::memcmp(kFirst.data.data(), kSame.data.data(), sizeof("CreateRemoteThread")) != 0);
+
+    CHECK(std::strcmp(kFirst.decrypt(), "CreateRemoteThread") == 0);
+    CHECK(std::strcmp(kSecond.decrypt(), "VirtualAllocExNuma") == 0);
+    CHECK(std::strcmp(kSame.decrypt(), "CreateRemoteThread") == 0);
+    CHECK(std::wcscmp(kWide.decrypt(), L"ntdll.dll") == 0);
+    kFirst.zeroize();
+    CHECK(kFirst.data[0] == '\0');
+    return obf_test::result();
+}
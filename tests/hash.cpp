@@ -0,0 +1,54 @@
+// obf::hash / obf::equal_to: obfuscated keys look up unordered containers of std::string
+// with the compile-time hash and a compare against the ciphertext, never decrypting.
+// The container lookups need C++20 heterogeneous lookup; a C++17 build checks the
+// functors alone.
+#include "obfuscator.h"
+#include "tests/check.h"
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+int main() {
+    std::unordered_map<std::string, int, obf::hash, obf::equal_to> m{
+        { "Authorization", 1 }, { "Content-Type", 2 }, { "X-Api-Key", 3 } };
+
+    auto& auth = OBF_REF("Authorization");
+    auto& key = OBF_REF("X-Api-Key");
+    auto& missing = OBF_REF("Accept");
+    auto& almost = OBF_REF("Authorizatioz");
+
+    CHECK(obf::hash{}(auth) == obf::hash{}(std::string("Authorization")));
+    CHECK(obf::hash{}(auth) == obf::hash{}(std::string_view("Authorization")));
+#if defined(__cpp_lib_generic_unordered_lookup)
+    auto it = m.find(auth);
+    CHECK(it != m.end() && it->second == 1);
+    CHECK(m.find(key) != m.end() && m.find(key)->second == 3);
+    CHECK(m.find(missing) == m.end());
+    CHECK(m.find(almost) == m.end());
+    CHECK(m.count(auth) == 1);
+#else
+    CHECK(m.count("Authorization") == 1);
+    CHECK(!obf::equal_to{}(missing, std::string("Authorization")));
+    CHECK(!obf::equal_to{}(almost, std::string("Authorization")));
+#endif
+    CHECK(obf::equal_to{}(key, std::string("X-Api-Key")));
+    CHECK(auth.c_str() == nullptr && key.c_str() == nullptr);
+
+    CHECK(obf::equal_to{}(auth, std::string("Authorization")));
+    CHECK(!obf::equal_to{}(std::string("Authorizatio"), auth));
+    CHECK(obf::equal_to{}(std::string("a"), std::string("a")));
+
+    // Decrypted keys still hash and compare the same.
+    auth.decrypt();
+    CHECK(obf::hash{}(auth) == obf::hash{}(std::string("Authorization")));
+    CHECK(obf::equal_to{}(auth, std::string("Authorization")));
+
+    auto& ntdll = OBF_W_REF(L"ntdll.dll");
+    CHECK(obf::hash{}(ntdll) == obf::hash{}(std::wstring(L"ntdll.dll")));
+#if defined(__cpp_lib_generic_unordered_lookup)
+    CHECK(m.find(auth) != m.end());
+    std::unordered_set<std::wstring, obf::hash, obf::equal_to> w{ L"ntdll.dll" };
+    CHECK(w.find(ntdll) != w.end());
+#endif
+    return obf_test::result();
+}
@@ -0,0 +1,28 @@
+// obf::remap_data_hugepages: the data segment moves onto huge-page-eligible memory with
+// its contents intact, and strings decrypted before and after the move read back.
+#include "obfuscator_hugepage.h"
+#include "tests/check.h"
+#include <cstring>
+
+// Makes the segment span several 2 MiB pages, so some of it can actually move.
+static unsigned char filler[6u << 20];
+
+const char* before() { return OBF("decrypted before the remap"); }
+const char* after() { return OBF("decrypted after the remap"); }
+
+int main() {
+    for (std::size_t i = 0; i < sizeof(filler); ++i) {
+        filler[i] = static_cast<unsigned char>(i * 131);
+    }
+    const char* b = before();
+    CHECK(obf::remap_data_hugepages() >= obff_internal::huge_page_size);
+    bool intact = true;
+    for (std::size_t i = 0; i < sizeof(filler); ++i) {
+        intact &= filler[i] == static_cast<unsigned char>(i * 131);
+    }
+    CHECK(intact);
+    CHECK(std::strcmp(b, "decrypted before the remap") == 0);
+    CHECK(std::strcmp(after(), "decrypted after the remap") == 0);
+    CHECK(before() == b);
+    return obf_test::result();
+}
@@ -0,0 +1,71 @@
+// obf::encrypted_sink / obf::encrypted_source: odd-sized writes and flushes round-trip,
+// the file holds no plaintext, and a wrong secret reads back garbage.
+#include "obfuscator_io.h"
+#include "tests/check.h"
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+int main() {
+    const std::string path = "/tmp/obf_io_test_" + std::to_string(getpid()) + ".bin";
+    std::vector<uint8_t> data(300'001);
+    uint64_t x = 1;
+    for (auto& b : data) {
+        x = x * 6364136223846793005ull + 1442695040888963407ull;
+        b = static_cast<uint8_t>(x >> 56);
+    }
+
+    auto out = obf::encrypted_sink::open(path.c_str(), 42, 64 << 10);
+    CHECK(out.valid());
+    std::size_t pos = 0;
+    for (int k = 1; pos < data.size(); ++k) {
+        const std::size_t n = std::min<std::size_t>(data.size() - pos, static_cast<std::size_t>(k * 811 % 9000 + 1));
+        CHECK(out.write(data.data() + pos, n));
+        pos += n;
+        if (k % 7 == 0) {
+            CHECK(out.flush());
+        }
+    }
+    CHECK(out.write(std::string_view("tail-line\n")));
+    CHECK(out.size() == data.size() + 10);
+    CHECK(out.close() && out.error() == 0);
+
+    std::FILE* f = std::fopen(path.c_str(), "rb");
+    CHECK(f != nullptr);
+    std::vector<uint8_t> raw(data.size() + 8192);
+    const std::size_t got = f != nullptr ? std::fread(raw.data(), 1, raw.size(), f) : 0;
+    if (f != nullptr) {
+        std::fclose(f);
+    }
+    CHECK(got == 4096 + data.size() + 10);
+    CHECK(std::memcmp(raw.data() + 4096, data.data(), 64) != 0);
+    CHECK(memmem(raw.data(), got, "tail-line", 9) == nullptr);
+
+    auto in = obf::encrypted_source::open(path.c_str(), 42);
+    CHECK(in.valid());
+    std::vector<uint8_t> back;
+    uint8_t buf[7777];
+    for (std::size_t k = 1;; ++k) {
+        const std::size_t n = in.read(buf, k * 131 % sizeof(buf) + 1);
+        if (n == 0) {
+            break;
+        }
+        back.insert(back.end(), buf, buf + n);
+    }
+    CHECK(in.error() == 0);
+    CHECK(back.size() == data.size() + 10);
+    CHECK(back.size() == data.size() + 10 && std::memcmp(back.data(), data.data(), data.size()) == 0 &&
+          std::memcmp(back.data() + data.size(), "tail-line\n", 10) == 0);
+
+    auto wrong = obf::encrypted_source::open(path.c_str(), 43);
+    CHECK(wrong.read(buf, 100) == 100 && std::memcmp(buf, data.data(), 100) != 0);
+    CHECK(!obf::encrypted_source::open("/nonexistent/obf", 42).valid());
+
+    // Failures are reported, not thrown.
+    auto huge = obf::encrypted_sink::open(path.c_str(), 42, SIZE_MAX / 4);
+    CHECK(!huge.valid() && huge.error() == ENOMEM && !huge.write("x") && !huge.close());
+    unlink(path.c_str());
+    return obf_test::result();
+}
@@ -0,0 +1,48 @@
+// obf::shm_channel: messages round-trip, the shared pages hold only ciphertext, and a
+// corrupted length field is rejected before anything is copied.
+#include "obfuscator_ipc.h"
+#include "tests/check.h"
+#include <cstring>
+#include <sys/mman.h>
+#include <unistd.h>
+
+int main() {
+    const uint64_t secret = 0x5eed;
+    auto tx = obf::shm_channel::create(4096, secret);
+    auto rx = obf::shm_channel::attach(dup(tx.fd()), secret);
+    CHECK(tx.valid() && rx.valid());
+    CHECK(tx.max_message() == 4096 - 32);
+    CHECK(!tx.try_send("x", 5000));
+    CHECK(!tx.try_send("x", SIZE_MAX));
+    CHECK(!tx.try_send("x", SIZE_MAX - 40));
+
+    auto* shared = static_cast<uint8_t*>(mmap(nullptr, 2 * 4096, PROT_READ | PROT_WRITE, MAP_SHARED, tx.fd(), 0));
+    CHECK(shared != MAP_FAILED);
+    uint8_t* ring = shared + 4096;
+
+    char out[64];
+    std::size_t n = 1;
+    CHECK(!rx.try_receive(out, sizeof(out), n));
+    CHECK(tx.try_send("hello, channel", 14));
+    CHECK(memmem(ring, 4096, "hello", 5) == nullptr);
+    CHECK(!rx.try_receive(out, 4, n) && n == 14);
+    CHECK(rx.try_receive(out, sizeof(out), n) && n == 14 && std::memcmp(out, "hello, channel", 14) == 0);
+
+    // The length sits in plain at the start of the record; a peer can write anything there.
+    const uint64_t lengths[] = { ~uint64_t{0}, 1 << 20, 4096 - 31, 100 };
+    std::size_t record = 64;
+    for (uint64_t length : lengths) {
+        CHECK(tx.try_send("abc", 3));
+        std::memcpy(ring + record, &length, sizeof(length));
+        std::memset(out, 0x5a, sizeof(out));
+        n = 1;
+        CHECK(!rx.try_receive(out, sizeof(out), n) && n == 0);
+        CHECK(out[0] == 0x5a);
+        const uint64_t fixed = 3;
+        std::memcpy(ring + record, &fixed, sizeof(fixed));
+        CHECK(rx.try_receive(out, sizeof(out), n) && n == 3 && std::memcmp(out, "abc", 3) == 0);
+        record += 64;
+    }
+    munmap(shared, 2 * 4096);
+    return obf_test::result();
+}
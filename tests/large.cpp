@@ -0,0 +1,41 @@
+// OBF_LARGE family: round trips across block boundaries and per-blob default seeds.
+#include "obfuscator.h"
+#include "tests/check.h"
+#include <cstring>
+#include <cwchar>
+#include <vector>
+
+#define S64 "0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef"
+#define S1K S64 S64 S64 S64 S64 S64 S64 S64 S64 S64 S64 S64 S64 S64 S64 S64
+#define S5K S1K S1K S1K S1K S1K
+#define BLOB_A S5K "tail of blob A"
+#define BLOB_B S5K "tail of blob B"
+
+int main() {
+    static_assert(sizeof(BLOB_A) > 4096);
+
+    const char* a = OBF_LARGE(BLOB_A);
+    CHECK(std::strcmp(a, BLOB_A) == 0);
+    CHECK(std::strcmp(OBF_LARGE_SEED(BLOB_B, 7), BLOB_B) == 0);
+    CHECK(std::wcscmp(OBF_W_LARGE(L"" S64 S64), L"" S64 S64) == 0);
+    CHECK(std::wcscmp(OBF_W_LARGE_SEED(L"wide", 9), L"wide") == 0);
+
+    // Equal length and contents up to the last block: the default seeds must still differ,
+    // or the two ciphertexts XOR to the XOR of the plaintexts.
+    auto& xa = OBF_LARGE_REF(BLOB_A);
+    auto& xb = OBF_LARGE_REF(BLOB_B);
+    bool key_streams_differ = false;
+    for (std::size_t i = 0; i < sizeof(BLOB_A); ++i) {
+        const char ca = xa.blocks[i / 4096].v[i % 4096];
+        const char cb = xb.blocks[i / 4096].v[i % 4096];
+        key_streams_differ |= (ca ^ cb) != (BLOB_A[i] ^ BLOB_B[i]);
+    }
+    CHECK(key_streams_differ);
+
+    std::vector<char> out(sizeof(BLOB_B));
+    xb.decrypt_to(out.data());
+    CHECK(std::memcmp(out.data(), BLOB_B, sizeof(BLOB_B)) == 0);
+    CHECK(xb.c_str() == nullptr);
+    CHECK(std::strcmp(xb.decrypt(), BLOB_B) == 0);
+    return obf_test::result();
+}
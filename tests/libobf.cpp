@@ -0,0 +1,78 @@
+// The header built with OBF_USE_LIB, linked against libobf/obf.cpp: strings decrypt,
+// compare and re-encrypt through the library's kernels, and the C ABI matches the header.
+#define OBF_USE_LIB
+#include "obfuscator.h"
+#include "tests/check.h"
+#include <cstring>
+#include <string_view>
+
+int main() {
+    CHECK(obf_abi_version() == OBF_LIB_ABI_VERSION);
+    const std::string_view isa = obf_kernel_isa();
+    CHECK(isa == "avx512f" || isa == "avx2" || isa == "sse2" || isa == "generic");
+
+    CHECK(std::strcmp(OBF("short"), "short") == 0);
+    // Past 128 bytes, so the unrolled SIMD loop and its tails all run.
+    CHECK(std::strcmp(OBF("0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef"
+                          "0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef!"),
+                      "0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef"
+                      "0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef!") == 0);
+    CHECK(std::wcscmp(OBF_W(L"a wide string longer than one 32-unit key"),
+                      L"a wide string longer than one 32-unit key") == 0);
+
+    auto& token = OBF_REF("token-0123456789abcdef0123456789abcdef");
+    CHECK(token.equals("token-0123456789abcdef0123456789abcdef"));
+    CHECK(!token.equals("token-0123456789abcdef0123456789abcdeF"));
+    CHECK(token.compare("token-0123456789abcdef0123456789abcdeF") > 0);
+    CHECK(token.compare("token-0123456789abcdef0123456789abcdeg") < 0);
+    CHECK(token.compare("token-0123456789abcdef0123456789abcdef") == 0);
+    CHECK(std::strcmp(token.decrypt(), "token-0123456789abcdef0123456789abcdef") == 0);
+    token.reencrypt();
+    CHECK(token.equals("token-0123456789abcdef0123456789abcdef"));
+    CHECK(std::strcmp(token.decrypt(), "token-0123456789abcdef0123456789abcdef") == 0);
+
+    auto& wide = OBF_W_REF(L"wide-0123456789abcdef0123456789abcdef");
+    CHECK(wide.equals(L"wide-0123456789abcdef0123456789abcdef"));
+    CHECK(wide.compare(L"wide-0123456789abcdef0123456789abcdeF") > 0);
+
+    // The library's key derivation and kernels agree with the header's own.
+    uint8_t key[32];
+    obf_rolling_key(0x1234, key);
+    const auto header_key = obff_internal::make_rolling_key<32>(0x1234);
+    CHECK(std::memcmp(key, header_key.data(), 32) == 0);
+
+    uint8_t plain[300];
+    uint8_t cipher[300];
+    uint8_t out[300];
+    for (std::size_t i = 0; i < sizeof(plain); ++i) {
+        plain[i] = static_cast<uint8_t>(i * 7 + 1);
+        cipher[i] = plain[i] ^ key[i % 32];
+    }
+    std::memcpy(out, cipher, sizeof(out));
+    obf_xor_key_stream(out, out, sizeof(out), 1, key);
+    CHECK(std::memcmp(out, plain, sizeof(out)) == 0);
+    CHECK(obf_xor_key_mismatch(cipher, plain, sizeof(plain), 1, key) == sizeof(plain));
+    out[257] ^= 1;
+    CHECK(obf_xor_key_mismatch(cipher, out, sizeof(out), 1, key) == 257);
+    CHECK(!obf_xor_key_equal(cipher, out, sizeof(out), 1, key));
+
+    uint8_t consumed[300];
+    std::memcpy(consumed, plain, sizeof(consumed));
+    obf_xor_key_stream_consume(out, consumed, sizeof(consumed), key);
+    CHECK(std::memcmp(out, cipher, sizeof(out)) == 0);
+    bool zeroed = true;
+    for (uint8_t b : consumed) {
+        zeroed &= b == 0;
+    }
+    CHECK(zeroed);
+
+    // Code units other than 1, 2 or 4 are rejected without touching memory.
+    std::memcpy(out, cipher, sizeof(out));
+    for (std::size_t unit : { std::size_t{0}, std::size_t{3}, std::size_t{8}, SIZE_MAX }) {
+        obf_xor_key_stream(out, out, 4, unit, key);
+        CHECK(obf_xor_key_equal(cipher, cipher, 4, unit, key) == 0);
+        CHECK(obf_xor_key_mismatch(cipher, cipher, 4, unit, key) == 0);
+    }
+    CHECK(std::memcmp(out, cipher, sizeof(out)) == 0);
+    return obf_test::result();
+}
@@ -0,0 +1,57 @@
+// OBF_NUMA / OBF_W_NUMA: node-local replicas read back the plaintext, stay out of the
+// encrypted static, and are tracked like any decrypted string.
+#include "obfuscator_numa.h"
+#include "tests/check.h"
+#include <cstring>
+#include <cwchar>
+#include <sys/resource.h>
+
+const char* hot() { return OBF_NUMA("hot numa string"); }
+
+int main() {
+    // Before any node arena exists: with no address space left for one, reads fall back
+    // to decrypting the static.
+    rlimit as{};
+    getrlimit(RLIMIT_AS, &as);
+    rlimit tight = as;
+    tight.rlim_cur = 0;
+    CHECK(setrlimit(RLIMIT_AS, &tight) == 0);
+    const char* fallback = OBF_NUMA("no arena for this one, node-local chunks are 2 MiB");
+    setrlimit(RLIMIT_AS, &as);
+    CHECK(fallback != nullptr && std::strcmp(fallback, "no arena for this one, node-local chunks are 2 MiB") == 0);
+
+    const std::size_t before = obf::resident_plaintext();
+    const char* p = hot();
+    CHECK(p != nullptr && std::strcmp(p, "hot numa string") == 0);
+    CHECK(hot() == p);
+    CHECK(obf::resident_plaintext() == before + 1);
+    const wchar_t* w = OBF_W_NUMA(L"wide numa string");
+    CHECK(w != nullptr && std::wcscmp(w, L"wide numa string") == 0);
+
+    // Wiping zeroes the replicas; the next read decrypts into the same node memory, so
+    // repeated wipes do not grow the arena.
+    CHECK(obf::wipe_decrypted() >= 2);
+    CHECK(obf::resident_plaintext() == 0);
+    CHECK(p[0] == '\0');
+    const char* again = hot();
+    CHECK(again == p && std::strcmp(again, "hot numa string") == 0);
+    for (int i = 0; i < 1000; ++i) {
+        obf::wipe_decrypted();
+        again = hot();
+    }
+    CHECK(again == p && std::strcmp(again, "hot numa string") == 0);
+
+    // Replicas are wiped when they go away, as strings are at exit.
+    const char* gone = nullptr;
+    {
+        static obff_internal::XorString<sizeof("scoped replica"), 99> xs("scoped replica");
+        obf::numa_replicas<obff_internal::XorString<sizeof("scoped replica"), 99>> replicas;
+        gone = replicas.get(xs);
+        CHECK(std::strcmp(gone, "scoped replica") == 0);
+    }
+    CHECK(gone[0] == '\0');
+
+    obf::numa_wipe();
+    CHECK(hot()[0] == '\0');
+    return obf_test::result();
+}
@@ -0,0 +1,72 @@
+// obfuscator_parallel.h: obf::warm over the registry, parallel_decrypt on the pooled
+// threads, and parallel_for falling back to the caller when the pool is taken. A site
+// warmed but never reached holds no plaintext once the process exits.
+#define OBF_REGISTRY
+#include "obfuscator_parallel.h"
+#include "tests/check.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+#define S64 "0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef"
+#define S1K S64 S64 S64 S64 S64 S64 S64 S64 S64 S64 S64 S64 S64 S64 S64 S64
+#define S16K S1K S1K S1K S1K S1K S1K S1K S1K S1K S1K S1K S1K S1K S1K S1K S1K
+#define S128K S16K S16K S16K S16K S16K S16K S16K S16K
+#define S1M S128K S128K S128K S128K S128K S128K S128K S128K
+
+const char* first() { return OBF("warm me"); }
+const wchar_t* second() { return OBF_W(L"and me"); }
+const char* never() { return OBF("warmed, never reached"); }
+
+// Registered before warm(), so it runs after warm's own exit handler.
+const char* unreached = nullptr;
+
+void check_unreached() {
+    if (unreached != nullptr && std::memcmp(unreached, "warmed, never reached", 22) == 0) {
+        std::fprintf(stderr, "plaintext of a warmed site survived exit\n");
+        std::_Exit(1);
+    }
+}
+
+int main() {
+    std::atexit(check_unreached);
+    auto& a = OBF_REF("warm me");
+    CHECK(a.c_str() == nullptr);
+    CHECK(obf::warm(4) >= 3);
+    CHECK(a.c_str() != nullptr && std::strcmp(a.c_str(), "warm me") == 0);
+    CHECK(std::strcmp(first(), "warm me") == 0);
+    CHECK(std::wcscmp(second(), L"and me") == 0);
+    for (auto* e = obff_internal::site_list.load(); e != nullptr; e = e->next) {
+        if (std::memcmp(e->object, "warmed, never reached", 22) == 0) {
+            unreached = static_cast<const char*>(e->object);
+        }
+    }
+    CHECK(unreached != nullptr);
+
+    auto& blob = OBF_LARGE_REF(S1M "end");
+    const char* p = obf::parallel_decrypt(blob, 4);
+    CHECK(std::strlen(p) == sizeof(S1M "end") - 1);
+    CHECK(std::strcmp(p + sizeof(S1M) - 1, "end") == 0);
+    CHECK(obf::parallel_decrypt(blob, 4) == p);
+
+    // Every task runs exactly once, whether it lands on a pool thread or the caller,
+    // including from several callers at once (all but one run alone).
+    for (int round = 0; round < 50; ++round) {
+        std::atomic<int> hits[257]{};
+        auto work = [&] {
+            obff_internal::parallel_for(257, 8, [&](std::size_t t) {
+                hits[t].fetch_add(1, std::memory_order_relaxed);
+            });
+        };
+        std::thread other(work);
+        work();
+        other.join();
+        bool twice = true;
+        for (auto& h : hits) {
+            twice &= h.load() == 2;
+        }
+        CHECK(twice);
+    }
+    return obf_test::result();
+}
@@ -0,0 +1,66 @@
+// OBF_PREFETCH and obf::decrypt_ahead: prefetching leaves the string encrypted, and a
+// queued decryption lands on the background thread without the caller's help, in a
+// fork() child too.
+#include "obfuscator_parallel.h"
+#include "tests/check.h"
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <cwchar>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+
+template<typename XS>
+bool wait_decrypted(const XS& xs) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (xs.c_str() == nullptr) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::yield();
+    }
+    return true;
+}
+
+int main() {
+    auto& host = OBF_REF("api.internal.example");
+    auto& wide = OBF_W_REF(L"wide host");
+    auto& blob = OBF_LARGE_REF("a large payload, prefetched from its head");
+    OBF_PREFETCH(host);
+    OBF_PREFETCH(wide);
+    OBF_PREFETCH(blob);
+    CHECK(host.c_str() == nullptr);
+    CHECK(wide.c_str() == nullptr);
+    CHECK(blob.c_str() == nullptr);
+    CHECK(std::strcmp(host.decrypt(), "api.internal.example") == 0);
+
+    auto& later = OBF_REF("needed a little later");
+    auto& wlater = OBF_W_REF(L"wide, later");
+    obf::decrypt_ahead(later);
+    obf::decrypt_ahead(wlater);
+    CHECK(wait_decrypted(later));
+    CHECK(wait_decrypted(wlater));
+    CHECK(std::strcmp(later.decrypt(), "needed a little later") == 0);
+    CHECK(std::wcscmp(wlater.decrypt(), L"wide, later") == 0);
+
+    // Racing the worker is fine: decrypt_once lets exactly one of them do the XOR.
+    auto& raced = OBF_REF("raced with the worker");
+    obf::decrypt_ahead(raced);
+    CHECK(std::strcmp(raced.decrypt(), "raced with the worker") == 0);
+
+    // The parent's worker thread does not survive fork(); the child needs one of its own,
+    // and must still get through exit without joining the thread it never had.
+    const pid_t child = fork();
+    if (child == 0) {
+        alarm(10);
+        auto& forked = OBF_REF("decrypted ahead in the child");
+        obf::decrypt_ahead(forked);
+        const bool ok = wait_decrypted(forked) && std::strcmp(forked.c_str(), "decrypted ahead in the child") == 0;
+        std::exit(ok ? 0 : 1);
+    }
+    int status = 0;
+    CHECK(child > 0 && waitpid(child, &status, 0) == child);
+    CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    return obf_test::result();
+}
@@ -0,0 +1,30 @@
+// OBF_PROFILE_GENERATE: every site counts its own uses, including sites sharing a line.
+#define OBF_PROFILE_GENERATE
+#include "obfuscator.h"
+#include "tests/check.h"
+#include <cstdlib>
+#include <cstring>
+#include <cwchar>
+
+int main() {
+    setenv("OBF_PROFILE_FILE", "/dev/null", 1);
+    for (int i = 0; i < 3; ++i) {
+        CHECK(std::strcmp(OBF("once"), "once") == 0 && std::wcscmp(OBF_W(L"w"), L"w") == 0);
+    }
+    CHECK(std::strcmp(OBF("other"), "other") == 0);
+
+    int sites = 0;
+    const obff_internal::site_profile* first = nullptr;
+    for (auto* p = obff_internal::profile_list.load(); p != nullptr; p = p->next) {
+        ++sites;
+        if (p->count.load() == 3) {
+            CHECK(first == nullptr || (first->line == p->line && first->id != p->id));
+            first = p;
+        } else {
+            CHECK(p->count.load() == 1);
+        }
+    }
+    CHECK(sites == 3);
+    CHECK(first != nullptr);
+    return obf_test::result();
+}
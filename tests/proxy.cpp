@@ -0,0 +1,44 @@
+// OBF_CMP / OBF_W_CMP: comparisons run on the ciphertext, and the string_view conversion
+// is the only implicit one, so member starts_with and pointer comparisons resolve. OBF
+// itself still returns a plain pointer.
+#include "obfuscator.h"
+#include "tests/check.h"
+#include <cstring>
+#include <cwchar>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+int main() {
+    auto tok = OBF_CMP("tok");
+    CHECK(tok.storage().c_str() == nullptr);
+    CHECK(tok == std::string_view("tok") && std::string("tok") == tok && tok != "toke");
+    const char* p = "x";
+    CHECK(p == OBF_CMP("x") && OBF_CMP("x") == p && p != OBF_CMP("y"));
+    CHECK(tok.storage().c_str() == nullptr);
+#if defined(__cpp_lib_three_way_comparison)
+    CHECK((tok <=> std::string_view("tol")) < 0 && (tok <=> std::string_view("tok")) == 0);
+#endif
+    CHECK(obf::starts_with(std::string_view("token"), tok) && !obf::starts_with(std::string_view("to"), tok));
+    CHECK(tok.storage().c_str() == nullptr);
+
+#if defined(__cpp_lib_starts_ends_with)
+    const std::string_view s = "token";
+    CHECK(s.starts_with(OBF_CMP("tok")) && !s.starts_with(OBF_CMP("ken")));
+#endif
+    const std::string str(OBF_CMP("built"));
+    CHECK(str == "built");
+    CHECK(std::strcmp(OBF_CMP("c api").c_str(), "c api") == 0);
+    CHECK(std::strcmp(static_cast<const char*>(tok), "tok") == 0);
+    CHECK(std::wstring_view(OBF_W_CMP(L"wide")) == L"wide" && OBF_W_CMP(L"wide") == std::wstring_view(L"wide"));
+
+    // Existing OBF call sites are untouched.
+    const auto plain = OBF("plain");
+    const auto wide = OBF_W(L"wide");
+    static_assert(std::is_same_v<decltype(plain), const char* const>);
+    static_assert(std::is_same_v<decltype(wide), const wchar_t* const>);
+    CHECK(std::strlen(OBF("plain")) == 5 && std::strcmp(plain, "plain") == 0);
+    CHECK(std::wcscmp(wide, L"wide") == 0);
+    CHECK(obf::starts_with(std::string_view("plain text"), OBF("plain")));
+    return obf_test::result();
+}
@@ -0,0 +1,40 @@
+#!/usr/bin/env bash
+# Builds and runs every tests/*.cpp (one executable each). Tests that link libobf get it
+# built by libobf/Makefile. Usage: tests/run.sh [name...]   (CXX / CXXFLAGS are honoured)
+set -uo pipefail
+
+CXX=${CXX:-g++}
+CXXFLAGS=${CXXFLAGS:--std=c++20 -O2 -Wall -Wextra -pthread}
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+names=("$@")
+if [ ${#names[@]} -eq 0 ]; then
+    for f in "$ROOT"/tests/*.cpp; do
+        names+=("$(basename "$f" .cpp)")
+    done
+fi
+
+failed=0
+for name in "${names[@]}"; do
+    extra=()
+    if [ "$name" = libobf ]; then
+        if ! make -s -C "$ROOT/libobf" OUT="$WORK" CXX="$CXX" CXXFLAGS="$CXXFLAGS" "$WORK/libobf.a"; then
+            printf '%-12s BUILD FAILED\n' "$name"
+            failed=1
+            continue
+        fi
+        extra=(-L"$WORK" -lobf)
+    fi
+    if ! $CXX $CXXFLAGS -I"$ROOT" "$ROOT/tests/$name.cpp" "${extra[@]}" -o "$WORK/$name"; then
+        printf '%-12s BUILD FAILED\n' "$name"
+        failed=1
+    elif ! "$WORK/$name"; then
+        printf '%-12s FAILED\n' "$name"
+        failed=1
+    else
+        printf '%-12s ok\n' "$name"
+    fi
+done
+exit $failed
@@ -0,0 +1,44 @@
+// obf::secret: ingest() encrypts out of the source buffer and zeroes it, the stored bytes
+// are not the plaintext, and decrypt_to / wipe behave.
+#include "obfuscator.h"
+#include "tests/check.h"
+#include <cstring>
+
+int main() {
+    char buf[] = "token-from-the-wire-0123456789abcdef-0123456789abcdef";
+    constexpr std::size_t n = sizeof(buf) - 1;
+    char copy[sizeof(buf)];
+    std::memcpy(copy, buf, sizeof(buf));
+
+    obf::secret<64> token;
+    CHECK(token.ingest(buf, n));
+    CHECK(token.size() == n);
+    bool zeroed = true;
+    for (std::size_t i = 0; i < n; ++i) {
+        zeroed &= buf[i] == '\0';
+    }
+    CHECK(zeroed);
+    CHECK(std::memcmp(&token, copy, n) != 0);
+
+    char out[64] = {};
+    token.decrypt_to(out);
+    CHECK(std::memcmp(out, copy, n) == 0);
+
+    // Re-ingesting the same bytes draws a fresh nonce, so the ciphertext changes.
+    unsigned char first[64];
+    std::memcpy(first, &token, sizeof(first));
+    std::memcpy(buf, copy, sizeof(buf));
+    CHECK(token.ingest(buf, n));
+    CHECK(std::memcmp(first, &token, n) != 0);
+    token.decrypt_to(out);
+    CHECK(std::memcmp(out, copy, n) == 0);
+
+    char too_long[65] = { 'x' };
+    obf::secret<64> other;
+    CHECK(!other.ingest(too_long, sizeof(too_long)));
+    CHECK(too_long[0] == 'x' && other.size() == 0);
+
+    token.wipe();
+    CHECK(token.size() == 0);
+    return obf_test::result();
+}
@@ -0,0 +1,73 @@
+// obf::decrypt_steps and obf::decrypt_async: budgeted decryption into a caller buffer,
+// one chunk per step or per tick of a (toy) event loop, with the static left encrypted.
+// decrypt_async needs C++20 coroutines; a C++17 build checks decrypt_steps alone.
+#include "obfuscator.h"
+#include "tests/check.h"
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <vector>
+
+#define S64 "0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef"
+#define S1K S64 S64 S64 S64 S64 S64 S64 S64 S64 S64 S64 S64 S64 S64 S64 S64
+#define BLOB S1K S1K S1K S1K S1K S1K S1K S1K S1K S1K "end of the blob"
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <coroutine>
+
+struct task {
+    struct promise_type {
+        task get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::abort(); }
+    };
+};
+
+std::deque<std::function<void()>> loop;
+
+template<typename XS>
+task decrypt_on_loop(const XS& xs, char* out, bool& finished) {
+    co_await obf::decrypt_async(xs, out, 1000, [](auto fn) { loop.push_back(std::move(fn)); });
+    finished = true;
+}
+#endif
+
+int main() {
+    auto& blob = OBF_LARGE_REF(BLOB);
+    std::vector<char> out(sizeof(BLOB));
+
+    auto op = obf::decrypt_steps(blob, out.data(), 1000);
+    int steps = 0;
+    while (!op.step()) {
+        ++steps;
+        CHECK(op.position() % 32 == 0);
+    }
+    CHECK(steps == static_cast<int>((sizeof(BLOB) + 1023) / 1024) - 1);  // 1000 rounds up to 1024
+    CHECK(std::memcmp(out.data(), BLOB, sizeof(BLOB)) == 0);
+    CHECK(blob.c_str() == nullptr);
+
+    auto& small = OBF_REF("short");
+    char s[sizeof("short")];
+    CHECK(obf::decrypt_steps(small, s, 1).step());
+    CHECK(std::strcmp(s, "short") == 0);
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+    std::fill(out.begin(), out.end(), '\0');
+    bool finished = false;
+    decrypt_on_loop(blob, out.data(), finished);
+    int ticks = 0;
+    while (!loop.empty()) {
+        auto fn = std::move(loop.front());
+        loop.pop_front();
+        fn();
+        ++ticks;
+    }
+    CHECK(finished);
+    CHECK(ticks == steps);
+    CHECK(std::memcmp(out.data(), BLOB, sizeof(BLOB)) == 0);
+    CHECK(blob.c_str() == nullptr);
+#endif
+    return obf_test::result();
+}
@@ -0,0 +1,53 @@
+// obf::to_string / obf::to_pmr_string: the text lands in the string's own buffer, through
+// the caller's allocator, and the static it came from stays encrypted.
+#include "obfuscator.h"
+#include "tests/check.h"
+#include <memory_resource>
+#include <string>
+
+namespace {
+
+std::size_t allocations = 0;
+
+template<typename T>
+struct counting_allocator {
+    using value_type = T;
+    counting_allocator() = default;
+    template<typename U>
+    counting_allocator(const counting_allocator<U>&) noexcept {}
+    T* allocate(std::size_t n) {
+        ++allocations;
+        return std::allocator<T>().allocate(n);
+    }
+    void deallocate(T* p, std::size_t n) noexcept { std::allocator<T>().deallocate(p, n); }
+    friend bool operator==(const counting_allocator&, const counting_allocator&) noexcept { return true; }
+    friend bool operator!=(const counting_allocator&, const counting_allocator&) noexcept { return false; }
+};
+
+}
+
+int main() {
+    auto& small = OBF_REF("sso");
+    CHECK(obf::to_string(small) == "sso");
+    CHECK(small.c_str() == nullptr);
+
+    auto& large = OBF_REF("a value well beyond any small-string buffer, so it allocates");
+    const auto s = obf::to_string(large, counting_allocator<char>());
+    CHECK(s == "a value well beyond any small-string buffer, so it allocates");
+    CHECK(allocations == 1);
+    CHECK(large.c_str() == nullptr);
+
+    auto& wide = OBF_W_REF(L"wide text");
+    CHECK(obf::to_string(wide) == L"wide text");
+    CHECK(wide.c_str() == nullptr);
+
+    char buffer[256];
+    std::pmr::monotonic_buffer_resource pool(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+    const auto p = obf::to_pmr_string(large, &pool);
+    CHECK(p == "a value well beyond any small-string buffer, so it allocates");
+    CHECK(p.data() >= buffer && p.data() < buffer + sizeof(buffer));
+
+    // Already-decrypted strings copy out the same text.
+    CHECK(std::string(small.decrypt()) == obf::to_string(small));
+    return obf_test::result();
+}
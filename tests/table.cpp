@@ -0,0 +1,53 @@
+// OBF_TABLE / obf::table: elements and gathers decode correctly, the stored words are
+// not the plaintext, and the key depends on the table's name and contents.
+#include "obfuscator.h"
+#include "tests/check.h"
+#include <cstdint>
+#include <cstring>
+
+OBF_TABLE(kSmall, uint8_t, 8, 0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5);
+OBF_TABLE(kTwin, uint8_t, 8, 0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5);
+OBF_TABLE(kWide, int64_t, 5, -1, 2, -3, 0x123456789abcll, 5);
+
+namespace {
+
+constexpr uint8_t small_plain[8] = { 0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5 };
+
+template<typename Table>
+bool stored_as_plaintext(const Table& t, const void* plain, std::size_t bytes) {
+    return std::memcmp(&t, plain, bytes) == 0;
+}
+
+}
+
+int main() {
+    CHECK(kSmall[0] == 0x63 && kSmall[3] == 0x7b && kSmall[7] == 0xc5);
+    CHECK(kWide[0] == -1 && kWide[2] == -3 && kWide[3] == 0x123456789abcll && kWide[4] == 5);
+    CHECK(kSmall.size() == 8);
+    CHECK(!stored_as_plaintext(kSmall, small_plain, sizeof(small_plain)));
+    CHECK(std::memcmp(&kSmall, &kTwin, 8) != 0);
+
+    static constexpr uint32_t u32_plain[20] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20 };
+    static const obf::table<uint32_t, 20, 0x7ab1e> u32(u32_plain);
+    const uint32_t idx[11] = { 19, 0, 5, 5, 7, 1, 18, 2, 3, 4, 6 };
+    uint32_t out[11] = {};
+    u32.lookup(idx, out, 11);
+    bool ok = true;
+    for (std::size_t k = 0; k < 11; ++k) {
+        ok &= out[k] == u32_plain[idx[k]];
+    }
+    CHECK(ok);
+    uint8_t bytes[11] = {};
+    const uint32_t small_idx[11] = { 7, 6, 5, 4, 3, 2, 1, 0, 7, 0, 4 };
+    kSmall.lookup(small_idx, bytes, 11);
+    ok = true;
+    for (std::size_t k = 0; k < 11; ++k) {
+        ok &= bytes[k] == small_plain[small_idx[k]];
+    }
+    CHECK(ok);
+    int64_t wide[5] = {};
+    const uint32_t wide_idx[5] = { 4, 3, 2, 1, 0 };
+    kWide.lookup(wide_idx, wide, 5);
+    CHECK(wide[0] == 5 && wide[1] == 0x123456789abcll && wide[4] == -1);
+    return obf_test::result();
+}
@@ -0,0 +1,57 @@
+// The decrypted-state tracker: resident_plaintext / for_each_decrypted follow decrypt,
+// reencrypt and zeroize; wipe_decrypted re-encrypts, so strings keep working afterwards;
+// zeroize is terminal and reads back empty, whether the string was decrypted or not.
+#include "obfuscator.h"
+#include "tests/check.h"
+#include <cstring>
+#include <cwchar>
+
+const char* first() { return OBF("first tracked"); }
+const wchar_t* second() { return OBF_W(L"second tracked"); }
+const char* large() { return OBF_LARGE("large tracked"); }
+
+int main() {
+    CHECK(obf::resident_plaintext() == 0);
+    first();
+    second();
+    large();
+    CHECK(obf::resident_plaintext() == 3);
+    std::size_t walked = 0;
+    obf::for_each_decrypted([&](void*) { ++walked; });
+    CHECK(walked == 3);
+
+    CHECK(obf::wipe_decrypted() == 3);
+    CHECK(obf::resident_plaintext() == 0);
+    auto& f = OBF_REF("first tracked");
+    CHECK(f.c_str() == nullptr);
+
+    // Wiped strings decrypt again on their next use.
+    CHECK(std::strcmp(first(), "first tracked") == 0);
+    CHECK(std::wcscmp(second(), L"second tracked") == 0);
+    CHECK(std::strcmp(large(), "large tracked") == 0);
+    CHECK(obf::resident_plaintext() == 3);
+
+    auto& r = OBF_REF("reencrypted by hand");
+    r.decrypt();
+    CHECK(obf::resident_plaintext() == 4);
+    r.reencrypt();
+    CHECK(r.c_str() == nullptr && obf::resident_plaintext() == 3);
+    CHECK(std::strcmp(r.decrypt(), "reencrypted by hand") == 0);
+
+    auto& z = OBF_REF("zeroized while decrypted");
+    z.decrypt();
+    z.zeroize();
+    CHECK(obf::resident_plaintext() == 4);
+    CHECK(z.decrypt()[0] == '\0');
+
+    // Zeroizing ciphertext must not leave a key stream behind for decrypt() to reveal.
+    auto& c = OBF_REF("zeroized while encrypted");
+    c.zeroize();
+    const char* p = c.decrypt();
+    bool empty = true;
+    for (std::size_t i = 0; i < sizeof("zeroized while encrypted"); ++i) {
+        empty &= p[i] == '\0';
+    }
+    CHECK(empty);
+    return obf_test::result();
+}
@@ -0,0 +1,35 @@
+// obf::window: a group of strings decrypted into one aligned block, mixed widths, the
+// statics left encrypted, and the block wiped on scope exit.
+#include "obfuscator.h"
+#include "tests/check.h"
+#include <cstdint>
+#include <cstring>
+#include <cwchar>
+#include <new>
+
+int main() {
+    auto& user = OBF_REF("svc-user");
+    auto& pass = OBF_REF("hunter2, but longer than one 32-byte key round");
+    auto& wide = OBF_W_REF(L"db.internal");
+
+    using window_type = decltype(obf::window{ user, pass, wide });
+    alignas(window_type) unsigned char storage[sizeof(window_type)];
+    auto* w = new (storage) window_type{ user, pass, wide };
+    CHECK(std::strcmp(w->get<0>(), "svc-user") == 0);
+    CHECK(std::strcmp(w->get<1>(), "hunter2, but longer than one 32-byte key round") == 0);
+    CHECK(std::wcscmp(w->get<2>(), L"db.internal") == 0);
+    CHECK(w->view<1>().size() == sizeof("hunter2, but longer than one 32-byte key round") - 1);
+    for (const void* p : { static_cast<const void*>(w->get<0>()), static_cast<const void*>(w->get<1>()),
+                           static_cast<const void*>(w->get<2>()) }) {
+        CHECK(reinterpret_cast<std::uintptr_t>(p) % 32 == 0);
+    }
+    CHECK(user.c_str() == nullptr && pass.c_str() == nullptr && wide.c_str() == nullptr);
+
+    w->~window();
+    bool wiped = true;
+    for (unsigned char c : storage) {
+        wiped &= c == 0;
+    }
+    CHECK(wiped);
+    return obf_test::result();
+}
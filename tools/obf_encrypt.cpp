@@ -0,0 +1,393 @@
+// Source-to-source pre-pass that encrypts OBF literals ahead of the compiler.
+//
+// Rewrites OBF("..."), OBF_SEED("...", seed), OBF_REF("...") and their OBF_W forms into
+// OBF_CIPHER / OBF_W_CIPHER / *_CIPHER_REF calls that carry the finished ciphertext, so
+// the compiler no longer constant-evaluates the key schedule and the encryption loop for
+// every literal. The tool includes obfuscator.h and uses its make_rolling_key, fnv1a and
+// literal_seed_n, so the output is bit-identical to the header-only path. The output opens
+// with a #line naming the input, and each rewritten call starts where the original did
+// and is followed by the newlines it spanned, so diagnostics, __FILE__ / __LINE__ and
+// profile site IDs stay those of the original source. No directive is emitted next to a
+// call, which may sit inside another macro's arguments. Anything it does not recognize
+// (macro arguments, concatenated literals, raw strings) is left as is, and the text of
+// comments and literals, raw strings included, is copied through untouched.
+//
+//   g++ -std=c++17 -O2 tools/obf_encrypt.cpp -o obf_encrypt
+//   ./obf_encrypt src/net.cpp -o build/gen/net.cpp
+#include "../obfuscator.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct macro {
+    const char* name;
+    const char* replacement;
+    bool wide;
+    bool seeded;
+};
+
+const macro macros[] = {
+    { "OBF", "OBF_CIPHER", false, false },
+    { "OBF_SEED", "OBF_CIPHER", false, true },
+    { "OBF_REF", "OBF_CIPHER_REF", false, false },
+    { "OBF_W", "OBF_W_CIPHER", true, false },
+    { "OBF_W_SEED", "OBF_W_CIPHER", true, true },
+    { "OBF_W_REF", "OBF_W_CIPHER_REF", true, false },
+};
+
+bool is_ident(char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+}
+
+void skip_space(const std::string& src, std::size_t& i) {
+    while (i < src.size() && std::isspace(static_cast<unsigned char>(src[i]))) {
+        ++i;
+    }
+}
+
+// Decodes UTF-8 into code points, for wide literals.
+std::vector<uint32_t> decode_utf8(const std::string& bytes) {
+    std::vector<uint32_t> out;
+    for (std::size_t i = 0; i < bytes.size();) {
+        const auto c = static_cast<unsigned char>(bytes[i]);
+        const int extra = c >= 0xf0 ? 3 : c >= 0xe0 ? 2 : c >= 0xc0 ? 1 : 0;
+        uint32_t cp = extra == 0 ? c : c & (0x3f >> extra);
+        for (int k = 1; k <= extra && i + k < bytes.size(); ++k) {
+            cp = (cp << 6) | (static_cast<unsigned char>(bytes[i + k]) & 0x3f);
+        }
+        out.push_back(cp);
+        i += static_cast<std::size_t>(extra) + 1;
+    }
+    return out;
+}
+
+// Parses the literal starting at src[i] ('"' already reached). Escapes are decoded to
+// code units; raw bytes are kept for narrow strings and UTF-8 decoded for wide ones.
+bool parse_literal(const std::string& src, std::size_t& i, bool wide, std::vector<uint32_t>& units) {
+    std::string pending;
+    auto flush = [&] {
+        if (wide) {
+            for (uint32_t cp : decode_utf8(pending)) {
+                units.push_back(cp);
+            }
+        } else {
+            for (char c : pending) {
+                units.push_back(static_cast<unsigned char>(c));
+            }
+        }
+        pending.clear();
+    };
+    for (++i; i < src.size(); ++i) {
+        const char c = src[i];
+        if (c == '"') {
+            flush();
+            ++i;
+            return true;
+        }
+        if (c == '\n') {
+            return false;
+        }
+        if (c != '\\') {
+            pending += c;
+            continue;
+        }
+        flush();
+        if (++i >= src.size()) {
+            return false;
+        }
+        const char e = src[i];
+        switch (e) {
+        case 'n': units.push_back('\n'); break;
+        case 't': units.push_back('\t'); break;
+        case 'r': units.push_back('\r'); break;
+        case 'a': units.push_back('\a'); break;
+        case 'b': units.push_back('\b'); break;
+        case 'f': units.push_back('\f'); break;
+        case 'v': units.push_back('\v'); break;
+        case '\\': case '\'': case '"': case '?': units.push_back(static_cast<unsigned char>(e)); break;
+        case 'x': {
+            uint32_t v = 0;
+            std::size_t digits = 0;
+            while (i + 1 < src.size() && std::isxdigit(static_cast<unsigned char>(src[i + 1]))) {
+                const char h = src[++i];
+                v = v * 16 + static_cast<uint32_t>(std::isdigit(static_cast<unsigned char>(h)) ? h - '0' : (h | 0x20) - 'a' + 10);
+                ++digits;
+            }
+            if (digits == 0) {
+                return false;
+            }
+            units.push_back(wide ? v : v & 0xff);
+            break;
+        }
+        default:
+            if (e < '0' || e > '7') {
+                return false;
+            }
+            uint32_t v = static_cast<uint32_t>(e - '0');
+            for (int k = 0; k < 2 && i + 1 < src.size() && src[i + 1] >= '0' && src[i + 1] <= '7'; ++k) {
+                v = v * 8 + static_cast<uint32_t>(src[++i] - '0');
+            }
+            units.push_back(wide ? v : v & 0xff);
+        }
+    }
+    return false;
+}
+
+// Without an explicit seed the literal's own, as OBF / OBF_W / *_REF compute it.
+template<typename CharT>
+std::string cipher_call(const char* replacement, const std::vector<uint32_t>& units, bool has_seed,
+                        std::size_t seed) {
+    std::vector<CharT> plain;
+    for (uint32_t u : units) {
+        if (sizeof(CharT) == 2 && u > 0xffff) {
+            plain.push_back(static_cast<CharT>(0xd800 + ((u - 0x10000) >> 10)));
+            plain.push_back(static_cast<CharT>(0xdc00 + ((u - 0x10000) & 0x3ff)));
+        } else {
+            plain.push_back(static_cast<CharT>(u));
+        }
+    }
+    plain.push_back(CharT{});
+    if (!has_seed) {
+        seed = obff_internal::literal_seed_n(plain.data(), plain.size());
+    }
+    const auto key = obff_internal::make_rolling_key<32>(seed);
+    std::ostringstream out;
+    out << replacement << '(' << plain.size() << ", " << seed << "u, 0x" << std::hex
+        << obff_internal::fnv1a(plain.data(), plain.size() - 1) << "ull";
+    for (std::size_t i = 0; i < plain.size(); ++i) {
+        const CharT c = plain[i] ^ static_cast<CharT>(key[i % 32]);
+        out << ", " << (sizeof(CharT) == 1 ? "'\\x" : "L'\\x")
+            << static_cast<uint64_t>(static_cast<std::make_unsigned_t<CharT>>(c)) << '\'';
+    }
+    out << ')';
+    return out.str();
+}
+
+std::string encrypt_call(const macro& m, const std::vector<uint32_t>& units, bool has_seed, std::size_t seed) {
+    if (m.wide) {
+        return cipher_call<wchar_t>(m.replacement, units, has_seed, seed);
+    }
+    return cipher_call<char>(m.replacement, units, has_seed, seed);
+}
+
+// True if the '"' at src[i] opens a raw string literal: R, u8R, uR, UR or LR before it.
+bool opens_raw_string(const std::string& src, std::size_t i) {
+    std::size_t start = i;
+    while (start > 0 && is_ident(src[start - 1])) {
+        --start;
+    }
+    const std::string prefix = src.substr(start, i - start);
+    return prefix == "R" || prefix == "u8R" || prefix == "uR" || prefix == "UR" || prefix == "LR";
+}
+
+// End of the raw string whose '"' is at src[i], just past its closing )delim". npos if
+// the delimiter is malformed; the end of src if the string is never closed.
+std::size_t raw_string_end(const std::string& src, std::size_t i) {
+    const std::size_t open = src.find('(', i + 1);
+    if (open == std::string::npos || open - i - 1 > 16) {
+        return std::string::npos;
+    }
+    const std::string delim = src.substr(i + 1, open - i - 1);
+    if (delim.find_first_of(" \\)\t\n\"") != std::string::npos) {
+        return std::string::npos;
+    }
+    const std::size_t close = src.find(')' + delim + '"', open + 1);
+    return close == std::string::npos ? src.size() : close + delim.size() + 2;
+}
+
+// True if the quote at src[i] is a digit separator, as in 1'000'000 or 0xff'ff: it follows
+// a (hex) digit inside a pp-number, rather than opening a character literal.
+bool digit_separator(const std::string& src, std::size_t i) {
+    if (i == 0 || !std::isxdigit(static_cast<unsigned char>(src[i - 1]))) {
+        return false;
+    }
+    std::size_t start = i;
+    while (start > 0 && (is_ident(src[start - 1]) || src[start - 1] == '\'' || src[start - 1] == '.')) {
+        --start;
+    }
+    const auto first = static_cast<unsigned char>(src[start]);
+    return std::isdigit(first) ||
+           (first == '.' && start + 1 < src.size() && std::isdigit(static_cast<unsigned char>(src[start + 1])));
+}
+
+// Tries to rewrite the macro call whose name starts at src[i]; on success appends the
+// replacement to out and moves i past the call.
+bool rewrite_call(const std::string& src, std::size_t& i, std::string& out) {
+    std::size_t end = i;
+    while (end < src.size() && is_ident(src[end])) {
+        ++end;
+    }
+    const std::string name = src.substr(i, end - i);
+    for (const macro& m : macros) {
+        if (name != m.name) {
+            continue;
+        }
+        std::size_t j = end;
+        skip_space(src, j);
+        if (j >= src.size() || src[j] != '(') {
+            return false;
+        }
+        ++j;
+        skip_space(src, j);
+        if (m.wide) {
+            if (j >= src.size() || src[j] != 'L') {
+                return false;
+            }
+            ++j;
+        }
+        if (j >= src.size() || src[j] != '"') {
+            return false;
+        }
+        std::vector<uint32_t> units;
+        if (!parse_literal(src, j, m.wide, units)) {
+            return false;
+        }
+        skip_space(src, j);
+        std::size_t seed = 0;
+        if (m.seeded) {
+            if (j >= src.size() || src[j] != ',') {
+                return false;
+            }
+            ++j;
+            skip_space(src, j);
+            const std::size_t digits = j;
+            while (j < src.size() && std::isdigit(static_cast<unsigned char>(src[j]))) {
+                seed = seed * 10 + static_cast<std::size_t>(src[j++] - '0');
+            }
+            while (j < src.size() && (src[j] == 'u' || src[j] == 'U' || src[j] == 'l' || src[j] == 'L')) {
+                ++j;
+            }
+            if (j == digits) {
+                return false;
+            }
+            skip_space(src, j);
+        }
+        if (j >= src.size() || src[j] != ')') {
+            return false;
+        }
+        out += encrypt_call(m, units, m.seeded, seed);
+        i = j + 1;
+        return true;
+    }
+    return false;
+}
+
+std::string quoted(const char* path) {
+    std::string q = "\"";
+    for (const char* p = path; *p != '\0'; ++p) {
+        if (*p == '"' || *p == '\\') {
+            q += '\\';
+        }
+        q += *p;
+    }
+    return q + '"';
+}
+
+// Copies src to out, rewriting recognized calls outside comments, literals (raw strings
+// included) and preprocessor directives. A rewritten call replaces the original in place,
+// on the line it started on; the newlines inside the original follow it.
+std::size_t rewrite(const std::string& src, const char* name, std::string& out) {
+    std::size_t rewritten = 0;
+    out += "#line 1 " + quoted(name) + '\n';
+    bool line_start = true;
+    for (std::size_t i = 0; i < src.size();) {
+        const char c = src[i];
+        if (line_start && c == '#') {
+            while (i < src.size() && !(src[i] == '\n' && src[i - 1] != '\\')) {
+                out += src[i++];
+            }
+            continue;
+        }
+        if (c == '\n') {
+            line_start = true;
+        } else if (!std::isspace(static_cast<unsigned char>(c))) {
+            line_start = false;
+        }
+        if (c == '/' && i + 1 < src.size() && (src[i + 1] == '/' || src[i + 1] == '*')) {
+            const bool block = src[i + 1] == '*';
+            const std::size_t stop = block ? src.find("*/", i + 2) : src.find('\n', i);
+            const std::size_t next = stop == std::string::npos ? src.size() : stop + (block ? 2 : 0);
+            out.append(src, i, next - i);
+            i = next;
+            continue;
+        }
+        if (c == '"' && opens_raw_string(src, i)) {
+            const std::size_t next = raw_string_end(src, i);
+            if (next != std::string::npos) {
+                out.append(src, i, next - i);
+                i = next;
+                continue;
+            }
+        }
+        if (c == '\'' && digit_separator(src, i)) {
+            out += src[i++];
+            continue;
+        }
+        if (c == '"' || c == '\'') {
+            out += src[i++];
+            while (i < src.size() && src[i] != c) {
+                if (src[i] == '\\' && i + 1 < src.size()) {
+                    out += src[i++];
+                }
+                out += src[i++];
+            }
+            if (i < src.size()) {
+                out += src[i++];
+            }
+            continue;
+        }
+        std::string call;
+        const std::size_t start = i;
+        if ((i == 0 || !is_ident(src[i - 1])) && c == 'O' && rewrite_call(src, i, call)) {
+            out += call;
+            out.append(static_cast<std::size_t>(std::count(src.begin() + static_cast<std::ptrdiff_t>(start),
+                                                           src.begin() + static_cast<std::ptrdiff_t>(i), '\n')),
+                       '\n');
+            ++rewritten;
+            continue;
+        }
+        out += src[i++];
+    }
+    return rewritten;
+}
+
+}
+
+int main(int argc, char** argv) {
+    const char* input = nullptr;
+    const char* output = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            output = argv[++i];
+        } else {
+            input = argv[i];
+        }
+    }
+    if (input == nullptr || output == nullptr) {
+        std::fprintf(stderr, "usage: %s input.cpp -o output.cpp\n", argv[0]);
+        return 2;
+    }
+    std::ifstream in(input, std::ios::binary);
+    if (!in) {
+        std::fprintf(stderr, "obf_encrypt: cannot read %s\n", input);
+        return 1;
+    }
+    std::ostringstream buffer;
+    buffer << in.rdbuf();
+    std::string out;
+    const std::size_t count = rewrite(buffer.str(), input, out);
+    std::ofstream dst(output, std::ios::binary);
+    if (!dst || !(dst << out)) {
+        std::fprintf(stderr, "obf_encrypt: cannot write %s\n", output);
+        return 1;
+    }
+    std::fprintf(stderr, "obf_encrypt: %zu literal(s) encrypted in %s\n", count, input);
+    return 0;
+}
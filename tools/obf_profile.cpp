@@ -0,0 +1,142 @@
+// Turns obf.profile files written by an OBF_PROFILE_GENERATE build into a policy header
+// for OBF_PROFILE_USE.
+//
+//   g++ -std=c++17 -O2 tools/obf_profile.cpp -o obf_profile
+//   ./obf_profile [--hot COUNT] [--cold COUNT] [--eager-ms MS] [-o obf_policy.h] obf.profile...
+//
+// Counts of the same site are summed over all runs; first-use times are taken relative
+// to the earliest first use of their run and the minimum over runs is kept.
+//   hot   - count >= --hot (default 10000)
+//   cold  - count <= --cold (default 1)
+//   eager - otherwise, first used within --eager-ms (default 50) of the run's start
+//   lazy  - everything else
+// Sites that never ran in any profile fall back to OBF_UNPROFILED_POLICY (cold).
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct site {
+    uint64_t count = 0;
+    int64_t first_use_ns = INT64_MAX;
+    unsigned line = 0;
+    std::string file;
+};
+
+struct sample {
+    uint64_t id;
+    uint64_t count;
+    int64_t first_use_ns;
+    unsigned line;
+    std::string file;
+};
+
+void merge_run(std::map<uint64_t, site>& sites, std::vector<sample>& run) {
+    int64_t start = INT64_MAX;
+    for (const auto& s : run) {
+        start = std::min(start, s.first_use_ns);
+    }
+    for (const auto& s : run) {
+        site& dst = sites[s.id];
+        dst.count += s.count;
+        dst.first_use_ns = std::min(dst.first_use_ns, s.first_use_ns - start);
+        dst.line = s.line;
+        dst.file = s.file;
+    }
+    run.clear();
+}
+
+bool read_profile(const char* path, std::map<uint64_t, site>& sites) {
+    std::ifstream in(path);
+    if (!in) {
+        return false;
+    }
+    std::vector<sample> run;
+    std::string text;
+    while (std::getline(in, text)) {
+        if (text.rfind("# run", 0) == 0) {
+            merge_run(sites, run);
+            continue;
+        }
+        std::istringstream fields(text);
+        sample s;
+        fields >> std::hex >> s.id >> std::dec >> s.count >> s.first_use_ns >> s.line;
+        if (!fields) {
+            continue;
+        }
+        std::getline(fields >> std::ws, s.file);
+        run.push_back(std::move(s));
+    }
+    merge_run(sites, run);
+    return true;
+}
+
+const char* classify(const site& s, uint64_t hot, uint64_t cold, int64_t eager_ns) {
+    if (s.count >= hot) {
+        return "hot";
+    }
+    if (s.count <= cold) {
+        return "cold";
+    }
+    if (s.first_use_ns <= eager_ns) {
+        return "eager";
+    }
+    return "lazy";
+}
+
+}
+
+int main(int argc, char** argv) {
+    uint64_t hot = 10000;
+    uint64_t cold = 1;
+    int64_t eager_ms = 50;
+    const char* output = "obf_policy.h";
+    std::vector<const char*> inputs;
+    for (int i = 1; i < argc; ++i) {
+        const bool has_value = i + 1 < argc;
+        if (std::strcmp(argv[i], "--hot") == 0 && has_value) {
+            hot = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--cold") == 0 && has_value) {
+            cold = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--eager-ms") == 0 && has_value) {
+            eager_ms = std::strtoll(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "-o") == 0 && has_value) {
+            output = argv[++i];
+        } else {
+            inputs.push_back(argv[i]);
+        }
+    }
+    if (inputs.empty()) {
+        std::fprintf(stderr, "usage: %s [--hot N] [--cold N] [--eager-ms MS] [-o header] profile...\n", argv[0]);
+        return 2;
+    }
+
+    std::map<uint64_t, site> sites;
+    for (const char* path : inputs) {
+        if (!read_profile(path, sites)) {
+            std::fprintf(stderr, "obf_profile: cannot read %s\n", path);
+            return 1;
+        }
+    }
+
+    std::FILE* out = std::fopen(output, "w");
+    if (out == nullptr) {
+        std::fprintf(stderr, "obf_profile: cannot write %s\n", output);
+        return 1;
+    }
+    std::fputs("// Generated by tools/obf_profile.cpp; do not edit.\n#pragma once\n", out);
+    for (const auto& [id, s] : sites) {
+        std::fprintf(out, "OBF_POLICY(0x%016" PRIx64 "ull, %s) // %s:%u count=%" PRIu64 " first=%.3fms\n", id,
+                     classify(s, hot, cold, eager_ms * 1000000), s.file.c_str(), s.line, s.count,
+                     static_cast<double>(s.first_use_ns) / 1e6);
+    }
+    std::fclose(out);
+    return 0;
+}